@@ -0,0 +1,313 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2015 Peter Walsh, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      BusPirate.c
+//
+//  DESCRIPTION
+//
+//      Bus Pirate binary I2C mode
+//
+//      (See BusPirate.h for a description)
+//
+//  VERSION:    2026.10.17
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include <avr/pgmspace.h>
+
+#include "UART.h"
+#include "Serial.h"
+#include "Job.h"
+#include "BusPirate.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data declarations
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#define BP_RESET        0x00            // Bitbang: "BBIO1"     I2C: back to bitbang
+#define BP_VERSION      0x01            //                      I2C: "I2C1"
+#define BP_I2C          0x02            // Bitbang: I2C mode    I2C: START
+#define BP_STOP         0x03
+#define BP_READ         0x04
+#define BP_ACK          0x06
+#define BP_NACK         0x07
+#define BP_WRITE_READ   0x08
+#define BP_EXIT         0x0F            // Bitbang: back to command line
+#define BP_WRITE        0x10            // 0x1x: Write x+1 bytes
+#define BP_PERIPH       0x40            // 0x4x: Peripherals
+#define BP_PULLUPS      0x04            //   Pullup bit of 0x4x
+#define BP_SPEED        0x60            // 0x6x: Speed
+
+static const uint16_t Speeds[4] PROGMEM = { 5, 50, 100, 400 };
+
+static struct {
+    uint8_t     Cmd;                    // Command being run
+    uint8_t     Byte;                   // Byte written or read
+    bool        I2CMode;                // TRUE if in I2C mode (else bitbang)
+    bool        Open;                   // TRUE if raw session holds the bus
+    bool        Acked;                  // TRUE if last byte read was ACKed
+    uint16_t    WrCount;                // Write then read counts
+    uint16_t    RdCount;
+    } BP;
+
+static uint8_t BPJob(JOB *Job);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// BPActive - Return TRUE if in Bus Pirate mode
+//
+// Inputs:      None.
+//
+// Outputs:     TRUE if Bus Pirate mode is running
+//
+bool BPActive(void) { return(FgJob.Run == BPJob); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// BPStart - Enter Bus Pirate mode
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void BPStart(void) {
+    JOB *Job = NewJob("BBIO",false);
+
+    if( Job != NULL )
+        StartJob(Job,BPJob);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// SessionOpen  - Return TRUE if our raw session holds the bus
+// SessionClose - Send STOP if our raw session holds the bus
+//
+// The driver ends a session which loses arbitration, so check the transfer as
+//   well as our flag.
+//
+// Inputs:      Job running the session
+//
+// Outputs:     TRUE if open (SessionOpen)
+//
+static bool SessionOpen(JOB *Job) {
+
+    return(BP.Open && Job->Xfer.Status == I2C_WORKING);
+    }
+
+static void SessionClose(JOB *Job) {
+
+    if( SessionOpen(Job) )
+        I2CRawStop();
+
+    BP.Open  = false;
+    BP.Acked = false;
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// BPJob - Run Bus Pirate commands from the UART
+//
+// Inputs:      Job to run
+//
+// Outputs:     Task state
+//
+static uint8_t BPJob(JOB *Job) {
+
+    TASK_BEGIN(Job->Task);
+
+    BP.I2CMode = false;
+    BP.Open    = false;
+    BP.Acked   = false;
+    PrintStringP(PSTR("BBIO1"));
+
+    while(1) {
+        TASK_WAIT(Job->Task,UARTReady());
+        BP.Cmd = GetUARTByte();
+
+        //
+        // Bitbang mode: only I2C is supported
+        //
+        if( !BP.I2CMode ) {
+            if     ( BP.Cmd == BP_RESET ) PrintStringP(PSTR("BBIO1"));
+            else if( BP.Cmd == BP_I2C   ) { PrintStringP(PSTR("I2C1")); BP.I2CMode = true; }
+            else if( BP.Cmd == BP_EXIT  ) { PutUARTByteW(0x01); TASK_EXIT(Job->Task); }
+            else                          { PutUARTByteW(0x00); }
+            continue;
+            }
+
+        //
+        // The last byte read was ACKed ahead of time (see BusPirate.h). Before
+        //   anything that ends the read, clock one more byte with NACK so the
+        //   slave lets go of SDA.
+        //
+        if( BP.Acked && (BP.Cmd == BP_RESET || BP.Cmd == BP_I2C  || BP.Cmd == BP_STOP ||
+                         BP.Cmd == BP_NACK  || BP.Cmd == BP_WRITE_READ) ) {
+            BP.Acked = false;
+            if( SessionOpen(Job) ) {
+                I2CRawStep(I2C_RAW_READ_NACK,0);
+                TASK_WAIT(Job->Task,I2CRawReady(&Job->Xfer));
+                }
+            }
+
+        if( BP.Cmd == BP_RESET ) {
+            SessionClose(Job);
+            BP.I2CMode = false;
+            PrintStringP(PSTR("BBIO1"));
+            }
+
+        else if( BP.Cmd == BP_VERSION )
+            PrintStringP(PSTR("I2C1"));
+
+        //
+        // START: the first one queues the session, which sends START when it
+        //   gets the bus. After that it's a repeated start.
+        //
+        else if( BP.Cmd == BP_I2C ) {
+            if( SessionOpen(Job) )
+                I2CRawStep(I2C_RAW_START,0);
+            else {
+                TASK_WAIT(Job->Task,XferIdle(Job));
+                SubmitXfer(Job,0,0,NULL,0,NULL,I2C_RAW);
+                BP.Open = true;
+                }
+            TASK_WAIT(Job->Task,I2CRawReady(&Job->Xfer));
+            PutUARTByteW(0x01);
+            }
+
+        else if( BP.Cmd == BP_STOP ) {
+            SessionClose(Job);
+            PutUARTByteW(0x01);
+            }
+
+        else if( BP.Cmd == BP_READ ) {
+            BP.Byte = 0xFF;
+            if( SessionOpen(Job) ) {
+                I2CRawStep(I2C_RAW_READ_ACK,0);
+                TASK_WAIT(Job->Task,I2CRawReady(&Job->Xfer));
+                if( SessionOpen(Job) ) {
+                    I2CRawResult(&BP.Byte);
+                    BP.Acked = true;
+                    }
+                }
+            PutUARTByteW(BP.Byte);
+            }
+
+        else if( BP.Cmd == BP_ACK || BP.Cmd == BP_NACK ) {
+            PutUARTByteW(0x01);
+            }
+
+        //
+        // Bulk write: 0x01 for the command, then the ACK bit of each byte
+        //
+        else if( (BP.Cmd & 0xF0) == BP_WRITE ) {
+            PutUARTByteW(0x01);
+            Job->Count = (BP.Cmd & 0x0F) + 1;
+            for( Job->Index = 0; Job->Index < Job->Count; Job->Index++ ) {
+                TASK_WAIT(Job->Task,UARTReady());
+                BP.Byte = GetUARTByte();
+                if( !SessionOpen(Job) ) {
+                    PutUARTByteW(0x01);
+                    continue;
+                    }
+                I2CRawStep(I2C_RAW_WRITE,BP.Byte);
+                TASK_WAIT(Job->Task,I2CRawReady(&Job->Xfer));
+                BP.Byte = SessionOpen(Job) && I2CRawResult(&BP.Byte) == I2C_COMPLETE ? 0x00 : 0x01;
+                PutUARTByteW(BP.Byte);
+                }
+            }
+
+        //
+        // Write then read: write count (2 bytes), read count (2 bytes), then the
+        //   data to write, starting with the address byte. This is one ordinary
+        //   transfer, so it needs the bus to itself.
+        //
+        else if( BP.Cmd == BP_WRITE_READ ) {
+            SessionClose(Job);
+            for( Job->Index = 0; Job->Index < 4; Job->Index++ ) {
+                TASK_WAIT(Job->Task,UARTReady());
+                Job->Buffer[Job->Index] = GetUARTByte();
+                }
+            BP.WrCount = (Job->Buffer[0] << 8) | Job->Buffer[1];
+            BP.RdCount = (Job->Buffer[2] << 8) | Job->Buffer[3];
+
+            if( BP.WrCount == 0 || BP.WrCount > Job->Size || BP.RdCount > Job->Size ) {
+                PutUARTByteW(0x00);
+                continue;
+                }
+
+            for( Job->Index = 0; Job->Index < BP.WrCount; Job->Index++ ) {
+                TASK_WAIT(Job->Task,UARTReady());
+                Job->Buffer[Job->Index] = GetUARTByte();
+                }
+
+            TASK_WAIT(Job->Task,XferIdle(Job));
+            SubmitXfer(Job,Job->Buffer[0] >> 1,BP.WrCount-1,Job->Buffer+1,
+                                               BP.RdCount  ,Job->Buffer  ,0);
+            TASK_WAIT(Job->Task,XferIdle(Job));
+
+            if( Job->Xfer.Status != I2C_COMPLETE ) {
+                PutUARTByteW(0x00);
+                continue;
+                }
+
+            PutUARTByteW(0x01);
+            for( Job->Index = 0; Job->Index < BP.RdCount; Job->Index++ ) {
+                TASK_WAIT(Job->Task,UARTRoom() > 0);
+                PutUARTByte(Job->Buffer[Job->Index]);
+                }
+            }
+
+        else if( (BP.Cmd & 0xF0) == BP_PERIPH ) {
+            I2CSetPullups(BP.Cmd & BP_PULLUPS);
+            PutUARTByteW(0x01);
+            }
+
+        else if( (BP.Cmd & 0xFC) == BP_SPEED ) {
+            I2CSetSpeed(pgm_read_word(&Speeds[BP.Cmd & 0x03]));
+            PutUARTByteW(0x01);
+            }
+
+        else {
+            PutUARTByteW(0x00);
+            }
+        }
+
+    TASK_END(Job->Task);
+    }
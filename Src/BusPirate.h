@@ -0,0 +1,109 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2015 Peter Walsh, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      BusPirate.h
+//
+//  SYNOPSIS
+//
+//      if( BPActive() ) ...                    // TRUE if in Bus Pirate mode
+//
+//      BPStart();                              // Enter Bus Pirate mode
+//
+//  DESCRIPTION
+//
+//      Bus Pirate binary I2C mode
+//
+//      Host tools written for the Bus Pirate (flashrom, pyBusPirateLite, sigrok,
+//        &c) drive the bus one byte at a time over the serial port. Twenty NULs
+//        at the command line (BP_ENTRY_NULS) enter binary bitbang mode, just as
+//        on the Bus Pirate; the host then selects I2C mode with 0x02.
+//
+//      Commands supported in I2C mode:
+//
+//          0x00        Back to bitbang mode     => "BBIO1"
+//          0x01        Mode version             => "I2C1"
+//          0x02        START (or restart)       => 0x01
+//          0x03        STOP                     => 0x01
+//          0x04        Read byte                => byte
+//          0x06        ACK last byte            => 0x01
+//          0x07        NACK last byte           => 0x01
+//          0x08        Write then read          => 0x01 + data, or 0x00
+//          0x1x        Write x+1 bytes          => 0x01, then 0x00 (ACK) or 0x01 (NACK) per byte
+//          0x4x        Peripherals (0x04 = pullups) => 0x01
+//          0x6x        Speed 5/50/100/400 KHz   => 0x01
+//
+//      0x0F in bitbang mode returns to the command line.
+//
+//      The AVR TWI must be told whether to ACK a byte *before* reading it, while
+//        the Bus Pirate reads first and lets the host decide. Reads are ACKed
+//        up front; a NACK (or STOP or restart) after an ACKed read clocks one
+//        more byte with NACK so the slave lets go of the bus. Slaves with auto
+//        incrementing registers see one extra read, which is harmless for
+//        nearly all of them.
+//
+//  VERSION:    2026.10.17
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef BUSPIRATE_H
+#define BUSPIRATE_H
+
+#include <stdbool.h>
+
+#define BP_ENTRY_NULS   20              // NULs in a row to enter binary mode
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// BPActive - Return TRUE if in Bus Pirate mode
+//
+// The foreground job owns the UART in Bus Pirate mode: the console and output
+//   tasks stand aside until it ends.
+//
+// Inputs:      None.
+//
+// Outputs:     TRUE if Bus Pirate mode is running
+//
+bool BPActive(void);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// BPStart - Enter Bus Pirate mode
+//
+// Runs as the foreground job, which must be free. If it can't get a buffer a
+//   message is printed, and the console carries on as before.
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void BPStart(void);
+
+#endif  // BUSPIRATE_H - entire file
@@ -0,0 +1,143 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2015 Peter Walsh, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      Checksum.c
+//
+//  DESCRIPTION
+//
+//      Incremental checksums of data read from the bus
+//
+//      See Checksum.h for a description of the interface.
+//
+//  VERSION:    2026.10.17
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include <avr/pgmspace.h>
+#include <util/crc16.h>
+
+#include "Checksum.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data declarations
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+//
+// CRC-32 is done a nibble at a time: 64 bytes of flash for the table, and about
+//   a quarter of the bit-at-a-time loop. Either is well ahead of the bus.
+//
+static const uint32_t CRC32Table[16] PROGMEM = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+    0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+    0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C };
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// CheckStart - Return the starting value of a checksum
+//
+// Inputs:      Type of checksum
+//
+// Outputs:     Running checksum
+//
+uint32_t CheckStart(CHECK_TYPE Type) {
+
+    if( Type == CHECK_CRC32 ) return(0xFFFFFFFF);
+    if( Type == CHECK_CRC16 ) return(0xFFFF);
+    return(0);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// CheckAdd - Add a block of data to a checksum
+//
+// Inputs:      Type of checksum
+//              Running checksum
+//              Data, and # bytes
+//
+// Outputs:     New running checksum
+//
+uint32_t CheckAdd(CHECK_TYPE Type, uint32_t Sum, const uint8_t *Data, uint8_t nBytes) {
+
+    if( Type == CHECK_CRC32 ) {
+        while( nBytes-- ) {
+            Sum ^= *Data++;
+            Sum  = (Sum >> 4) ^ pgm_read_dword(&CRC32Table[Sum & 0x0F]);
+            Sum  = (Sum >> 4) ^ pgm_read_dword(&CRC32Table[Sum & 0x0F]);
+            }
+        return(Sum);
+        }
+
+    if( Type == CHECK_CRC16 ) {
+        uint16_t CRC = Sum;
+
+        while( nBytes-- )
+            CRC = _crc_xmodem_update(CRC,*Data++);
+        return(CRC);
+        }
+
+    //
+    // Fletcher-16: two running sums, mod 255, in the low and high bytes
+    //
+    uint16_t Sum1 = Sum & 0xFF;
+    uint16_t Sum2 = Sum >> 8;
+
+    while( nBytes-- ) {
+        Sum1 += *Data++;
+        if( Sum1 >= 255 ) Sum1 -= 255;
+        Sum2 += Sum1;
+        if( Sum2 >= 255 ) Sum2 -= 255;
+        }
+    return((Sum2 << 8) | Sum1);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// CheckEnd - Return the final value of a checksum
+//
+// Inputs:      Type of checksum
+//              Running checksum
+//
+// Outputs:     Final checksum
+//
+uint32_t CheckEnd(CHECK_TYPE Type, uint32_t Sum) {
+
+    if( Type == CHECK_CRC32 )
+        return(~Sum);
+    return(Sum);
+    }
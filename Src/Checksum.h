@@ -0,0 +1,84 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2015 Peter Walsh, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      Checksum.h
+//
+//  SYNOPSIS
+//
+//      uint32_t Sum = CheckStart(CHECK_CRC32); // Start a checksum
+//
+//      Sum = CheckAdd(CHECK_CRC32,Sum,Data,nBytes);// Add a block of data
+//      Sum = CheckAdd(CHECK_CRC32,Sum,Data,nBytes);//   (as many as needed)
+//
+//      Sum = CheckEnd(CHECK_CRC32,Sum);        // Final value
+//
+//  DESCRIPTION
+//
+//      Incremental checksums of data read from the bus
+//
+//      The algorithms match the usual host tools, so a device's contents can
+//        be checked against an image file without sending the data:
+//
+//      CHECK_CRC32     CRC-32 (as zip, zlib, crc32 command). "123456789" => CBF43926
+//      CHECK_CRC16     CRC-16/CCITT-FALSE (poly 1021, init FFFF).      => 29B1
+//      CHECK_FLETCHER  Fletcher-16.                                    => 1EDE
+//
+//  VERSION:    2026.10.17
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <stdint.h>
+
+typedef enum {
+    CHECK_CRC32,                        // CRC-32
+    CHECK_CRC16,                        // CRC-16/CCITT-FALSE
+    CHECK_FLETCHER,                     // Fletcher-16
+    } CHECK_TYPE;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// CheckStart - Return the starting value of a checksum
+// CheckAdd   - Add a block of data to a checksum
+// CheckEnd   - Return the final value of a checksum
+//
+// Inputs:      Type of checksum
+//              Running checksum (CheckAdd and CheckEnd)
+//              Data, and # bytes (CheckAdd only)
+//
+// Outputs:     New running checksum (or final value, for CheckEnd)
+//
+uint32_t CheckStart(CHECK_TYPE Type);
+uint32_t CheckAdd  (CHECK_TYPE Type, uint32_t Sum, const uint8_t *Data, uint8_t nBytes);
+uint32_t CheckEnd  (CHECK_TYPE Type, uint32_t Sum);
+
+#endif  // CHECKSUM_H - entire file
@@ -0,0 +1,379 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2015 Peter Walsh, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      Config.c
+//
+//  DESCRIPTION
+//
+//      Persistent configuration, in the AVR's internal EEPROM
+//
+//      See Config.h for a description of the interface.
+//
+//  VERSION:    2026.10.17
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include <stddef.h>
+#include <string.h>
+#include <avr/eeprom.h>
+
+#include "Checksum.h"
+#include "Config.h"
+
+#define CONFIG_BLOCK    ((CONFIG  *)  CONFIG_EEPROM)
+#define CONFIG_TEXT     ((uint8_t *) (CONFIG_EEPROM + sizeof(CONFIG)))
+
+CONFIG Config;
+
+static bool     Saved;                  // EEPROM holds a good configuration
+static uint16_t ScriptAt;               // Next script char, CONFIG_SCRIPT_SIZE => done
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// ConfigCRC - Return the CRC of a configuration and the saved script
+//
+// Inputs:      Configuration to check
+//
+// Outputs:     CRC-16 of everything in it but the CRC, and the script up to its NUL
+//
+static uint16_t ConfigCRC(const CONFIG *Block) {
+    uint32_t Sum = CheckStart(CHECK_CRC16);
+    uint16_t Index;
+    uint8_t  Byte;
+
+    Sum = CheckAdd(CHECK_CRC16,Sum,(const uint8_t *) Block,offsetof(CONFIG,CRC));
+
+    for( Index = 0; Index < CONFIG_SCRIPT_SIZE; Index++ ) {
+        Byte = eeprom_read_byte(CONFIG_TEXT + Index);
+        Sum  = CheckAdd(CHECK_CRC16,Sum,&Byte,1);
+        if( Byte == 0 )
+            break;
+        }
+
+    return(CheckEnd(CHECK_CRC16,Sum));
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// ConfigDefaults - Fill in a configuration with the compiled in defaults
+//
+// Inputs:      Configuration to fill in
+//
+// Outputs:     None.
+//
+static void ConfigDefaults(CONFIG *Block) {
+
+    memset(Block,0,sizeof(*Block));
+    Block->Version  = CONFIG_VERSION;
+    Block->KHz      = CONFIG_KHZ;
+    Block->Pullups  = CONFIG_PULLUPS;
+    Block->OurAddr  = CONFIG_OUR_ADDR;
+    Block->Baud     = CONFIG_BAUD;
+    Block->FastBoot = CONFIG_FAST_BOOT;
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// ConfigInit - Load the configuration and apply it
+//
+// Inputs:      None.
+//
+// Outputs:     TRUE  if the configuration came from EEPROM
+//              FALSE if the defaults were used
+//
+bool ConfigInit(void) {
+    CONFIG_PROFILE *Profile;
+    bool            Loaded;
+
+    eeprom_read_block(&Config,CONFIG_BLOCK,sizeof(Config));
+
+    Loaded = Config.Version == CONFIG_VERSION && Config.CRC == ConfigCRC(&Config);
+    Saved  = Loaded;
+
+    if( !Loaded )
+        ConfigDefaults(&Config);
+
+    ScriptAt = Loaded && ConfigScript(0) != 0 ? 0 : CONFIG_SCRIPT_SIZE;
+
+    UARTSetBaud(Config.Baud);
+    I2CInit(Config.KHz,Config.OurAddr,Config.Pullups);
+
+    for( Profile = Config.Profiles; Profile < &Config.Profiles[I2C_PROFILES]; Profile++ ) {
+        if( Profile->Addr != 0 )
+            I2CSetProfile(Profile->Addr,Profile->KHz);
+        }
+
+    return(Loaded);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// ConfigStored - Read back the saved configuration
+// ConfigStore  - Write a configuration (and CRC) to EEPROM
+//
+// With nothing saved, ConfigStored() gives the defaults, and an empty script.
+//   Changing the stored copy and writing it back saves one setting without
+//   saving anything else which has been changed since.
+//
+// eeprom_update_xxx() only writes bytes which have changed, which saves time
+//   and EEPROM wear.
+//
+// Inputs:      Configuration to fill in (ConfigStored) or save (ConfigStore)
+//
+// Outputs:     None.
+//
+static void ConfigStored(CONFIG *Block) {
+
+    if( Saved ) {
+        eeprom_read_block(Block,CONFIG_BLOCK,sizeof(*Block));
+        return;
+        }
+
+    ConfigDefaults(Block);
+    eeprom_update_byte(CONFIG_TEXT,0);      // No script yet
+    }
+
+static void ConfigStore(CONFIG *Block) {
+
+    Block->Version = CONFIG_VERSION;
+    Block->CRC     = ConfigCRC(Block);
+    eeprom_update_block(Block,CONFIG_BLOCK,sizeof(*Block));
+    Saved = true;
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// ConfigSave  - Save the configuration (and CRC) to EEPROM
+// ConfigErase - Spoil the saved configuration, so the defaults are used at reset
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void ConfigSave(void) {
+
+    if( !Saved )
+        eeprom_update_byte(CONFIG_TEXT,0);  // No script yet
+
+    ConfigStore(&Config);
+    }
+
+void ConfigErase(void) {
+
+    eeprom_update_byte(&CONFIG_BLOCK->Version,0xFF);
+    Saved = false;
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// ConfigSaveProfile - Save one slave's profile to EEPROM, and nothing else
+//
+// The slave's entry in the saved configuration is replaced with the one in
+//   Config. Other settings changed since the last save stay unsaved.
+//
+// Inputs:      Slave address
+//
+// Outputs:     TRUE  if done
+//              FALSE if all the saved profiles are in use
+//
+bool ConfigSaveProfile(uint8_t SlaveAddr) {
+    CONFIG          Stored;
+    CONFIG_PROFILE *Profile;
+    CONFIG_PROFILE *Free = NULL;
+    uint16_t        KHz  = ConfigGetProfile(SlaveAddr);
+
+    ConfigStored(&Stored);
+
+    for( Profile = Stored.Profiles; Profile < &Stored.Profiles[I2C_PROFILES]; Profile++ ) {
+        if( Profile->Addr == SlaveAddr )
+            break;
+        if( Profile->Addr == 0 && Free == NULL )
+            Free = Profile;
+        }
+
+    if( Profile == &Stored.Profiles[I2C_PROFILES] ) {
+        if( KHz == 0 )
+            return(true);
+        if( (Profile = Free) == NULL )
+            return(false);
+        }
+
+    Profile->Addr = KHz ? SlaveAddr : 0;
+    Profile->KHz  = KHz;
+
+    ConfigStore(&Stored);
+    return(true);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// ConfigSetProfile - Set the bus speed for one slave, now and in the configuration
+//
+// Inputs:      Slave address
+//              Speed, in KHz (0 => remove profile)
+//
+// Outputs:     TRUE  if done
+//              FALSE if all the profiles are in use
+//
+bool ConfigSetProfile(uint8_t SlaveAddr, uint16_t KHz) {
+    CONFIG_PROFILE *Profile;
+    CONFIG_PROFILE *Free = NULL;
+
+    for( Profile = Config.Profiles; Profile < &Config.Profiles[I2C_PROFILES]; Profile++ ) {
+        if( Profile->Addr == SlaveAddr )
+            break;
+        if( Profile->Addr == 0 && Free == NULL )
+            Free = Profile;
+        }
+
+    if( Profile == &Config.Profiles[I2C_PROFILES] ) {
+        if( KHz == 0 )
+            return(true);
+        if( (Profile = Free) == NULL )
+            return(false);
+        }
+
+    if( !I2CSetProfile(SlaveAddr,KHz) )
+        return(false);
+
+    Profile->Addr = KHz ? SlaveAddr : 0;
+    Profile->KHz  = KHz;
+    return(true);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// ConfigGetProfile - Return the bus speed profile of one slave
+//
+// Inputs:      Slave address
+//
+// Outputs:     Speed, in KHz (0 => no profile)
+//
+uint16_t ConfigGetProfile(uint8_t SlaveAddr) {
+    CONFIG_PROFILE *Profile;
+
+    for( Profile = Config.Profiles; Profile < &Config.Profiles[I2C_PROFILES]; Profile++ ) {
+        if( Profile->Addr == SlaveAddr )
+            return(Profile->KHz);
+        }
+
+    return(0);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// ConfigSetScript - Save the startup script, and nothing else
+// ConfigScript    - Return one char of the saved startup script
+//
+// Inputs:      Commands, separated by ';' (empty => no script)
+//              Index of char (ConfigScript only)
+//
+// Outputs:     TRUE  if done                  (ConfigSetScript)
+//              FALSE if script is too long
+//              Char, ';' between commands, 0 at end (ConfigScript)
+//
+// The CRC covers the script, so the saved settings (or the defaults) are written
+//   back with it. Other settings changed since the last save stay unsaved: a
+//   mistyped BAUD mustn't get saved along with the script.
+//
+// Without a saved configuration there's no script.
+//
+bool ConfigSetScript(const char *Script) {
+    CONFIG Stored;
+    size_t Length = strlen(Script) + 1;
+
+    if( Length > CONFIG_SCRIPT_SIZE )
+        return(false);
+
+    ConfigStored(&Stored);
+    eeprom_update_block(Script,CONFIG_TEXT,Length);
+    ConfigStore(&Stored);
+    return(true);
+    }
+
+char ConfigScript(uint16_t Index) {
+
+    if( !Saved || Index >= CONFIG_SCRIPT_SIZE )
+        return(0);
+
+    return(eeprom_read_byte(CONFIG_TEXT + Index));
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// ConfigScriptReady - Return TRUE if the startup script has input waiting
+// ConfigScriptGet   - Return the next char of the startup script
+// ConfigScriptStop  - Stop the startup script
+//
+// The ';' between commands comes out as CR, and the last command gets one too.
+//
+// Inputs:      None.
+//
+// Outputs:     TRUE if script is running (ConfigScriptReady)
+//              Next char, CR between commands (ConfigScriptGet)
+//
+bool ConfigScriptReady(void) {
+
+    return(ScriptAt < CONFIG_SCRIPT_SIZE);
+    }
+
+char ConfigScriptGet(void) {
+    char Char = ConfigScript(ScriptAt++);
+
+    if( Char == 0 ) {
+        ScriptAt = CONFIG_SCRIPT_SIZE;
+        return('\r');
+        }
+
+    return(Char == ';' ? '\r' : Char);
+    }
+
+void ConfigScriptStop(void) {
+
+    ScriptAt = CONFIG_SCRIPT_SIZE;
+    }
@@ -0,0 +1,216 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2015 Peter Walsh, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      Config.h
+//
+//  SYNOPSIS
+//
+//      ConfigInit();                           // Load from EEPROM and apply, at startup
+//
+//      Config.KHz = 400;                       // Change a setting
+//      ConfigSetProfile(SlaveAddr,KHz);        // Give a slave its own bus speed
+//      KHz = ConfigGetProfile(SlaveAddr);      // Slave's own bus speed, 0 if none
+//      ConfigSetScript("S;G 68 0 8");          // Save the startup script (only)
+//      ConfigSave();                           // Save settings to EEPROM
+//      ConfigSaveProfile(SlaveAddr);           // Save just one slave's profile
+//      ConfigErase();                          // Back to defaults at next reset
+//
+//      if( ConfigScriptReady() ) ...           // Startup script has more input
+//      Char = ConfigScriptGet();               // Next char of the startup script
+//      ConfigScriptStop();                     // Skip the rest of it
+//
+//  DESCRIPTION
+//
+//      Persistent configuration, in the AVR's internal EEPROM
+//
+//      The settings are a versioned block at the start of EEPROM, followed by
+//        the startup script, and a CRC-16 covers both. A block which is blank,
+//        from another version, or fails the CRC is ignored, and the compiled in
+//        defaults are used.
+//
+//      The startup script is a list of commands separated by ';', which the
+//        console runs as though they were typed, one after another, after the
+//        banner.
+//
+//      Bus speed, pullups and profiles take effect straight away. The baud rate,
+//        our slave address and fast boot only change at reset.
+//
+//  VERSION:    2026.10.17
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "I2C.h"
+#include "UART.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// Defaults, used when the EEPROM has no (good) configuration
+//
+#define CONFIG_KHZ          100         // Bus speed
+#define CONFIG_PULLUPS      true        // Use internal bus pullups
+#define CONFIG_OUR_ADDR     0x31        // Our slave address, if anyone addresses us
+#define CONFIG_BAUD         BAUD        // UART baud rate
+#define CONFIG_FAST_BOOT    false       // Skip banner, send READY token instead
+
+//
+// Change CONFIG_VERSION whenever the CONFIG layout changes, so that an old block
+//   isn't taken for a new one.
+//
+#define CONFIG_VERSION      2
+#define CONFIG_EEPROM       0x000       // EEPROM address of CONFIG
+#define CONFIG_SCRIPT_SIZE  256         // EEPROM space for startup script (with NUL)
+
+typedef struct {
+    uint8_t     Addr;                   // Slave address, 0 => unused
+    uint16_t    KHz;                    // Bus speed for slave
+    } CONFIG_PROFILE;
+
+typedef struct {
+    uint8_t         Version;            // CONFIG_VERSION
+    uint16_t        KHz;                // Bus speed
+    bool            Pullups;            // Use internal bus pullups
+    uint8_t         OurAddr;            // Our slave address
+    uint32_t        Baud;               // UART baud rate
+    bool            FastBoot;           // Skip banner, send READY token instead
+    CONFIG_PROFILE  Profiles[I2C_PROFILES];
+    uint16_t        CRC;                // CRC-16 of the above, and the script
+    } CONFIG;
+
+extern CONFIG Config;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// ConfigInit - Load the configuration and apply it
+//
+// Sets the baud rate, and initializes the I2C driver. Call after UARTInit(),
+//   instead of I2CInit().
+//
+// Inputs:      None.
+//
+// Outputs:     TRUE  if the configuration came from EEPROM
+//              FALSE if the defaults were used
+//
+bool ConfigInit(void);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// ConfigSave  - Save the configuration (and CRC) to EEPROM
+// ConfigErase - Spoil the saved configuration, so the defaults are used at reset
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void ConfigSave (void);
+void ConfigErase(void);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// ConfigSaveProfile - Save one slave's profile to EEPROM, and nothing else
+//
+// Other unsaved changes stay unsaved.
+//
+// Inputs:      Slave address
+//
+// Outputs:     TRUE  if done
+//              FALSE if all the saved profiles are in use
+//
+bool ConfigSaveProfile(uint8_t SlaveAddr);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// ConfigSetProfile - Set the bus speed for one slave, now and in the configuration
+//
+// Inputs:      Slave address
+//              Speed, in KHz (0 => remove profile)
+//
+// Outputs:     TRUE  if done
+//              FALSE if all the profiles are in use
+//
+bool ConfigSetProfile(uint8_t SlaveAddr, uint16_t KHz);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// ConfigGetProfile - Return the bus speed profile of one slave
+//
+// Inputs:      Slave address
+//
+// Outputs:     Speed, in KHz (0 => no profile)
+//
+uint16_t ConfigGetProfile(uint8_t SlaveAddr);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// ConfigSetScript - Save the startup script, and nothing else
+// ConfigScript    - Return one char of the saved startup script
+//
+// Other unsaved changes stay unsaved.
+//
+// Inputs:      Commands, separated by ';' (empty => no script)
+//              Index of char (ConfigScript only)
+//
+// Outputs:     TRUE  if done                  (ConfigSetScript)
+//              FALSE if script is too long
+//              Char, ';' between commands, 0 at end (ConfigScript)
+//
+bool ConfigSetScript(const char *Script);
+char ConfigScript   (uint16_t Index);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// ConfigScriptReady - Return TRUE if the startup script has input waiting
+// ConfigScriptGet   - Return the next char of the startup script
+// ConfigScriptStop  - Stop the startup script
+//
+// The script only runs once, at startup.
+//
+// Inputs:      None.
+//
+// Outputs:     TRUE if script is running (ConfigScriptReady)
+//              Next char, CR between commands (ConfigScriptGet)
+//
+bool ConfigScriptReady(void);
+char ConfigScriptGet  (void);
+void ConfigScriptStop (void);
+
+#endif  // CONFIG_H - entire file
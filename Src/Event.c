@@ -0,0 +1,98 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2015 Peter Walsh, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      Event.c
+//
+//  DESCRIPTION
+//
+//      A tiny event flag dispatcher. See Event.h for details.
+//
+//  VERSION:    2026.10.17
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+
+#include "Event.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// EventInit - Initialize event processing
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void EventInit(void) {
+
+    EVENT_FLAGS = 0;
+
+    set_sleep_mode(SLEEP_MODE_IDLE);    // Peripherals keep running while asleep
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// WaitEvents - Sleep until an event is posted
+//
+// Inputs:      Mask of events to wait for
+//
+// Outputs:     Events that were posted (subset of mask)
+//
+uint8_t WaitEvents(uint8_t Mask) {
+    uint8_t Events;
+
+    while(1) {
+        //
+        // Check and clear with interrupts off, so that an event posted between
+        //   the check and the SLEEP cannot be lost.
+        //
+        cli();
+        Events = EVENT_FLAGS & Mask;
+
+        if( Events ) {
+            EVENT_FLAGS &= ~Events;
+            sei();
+            return(Events);
+            }
+
+        //
+        // The instruction following SEI is always executed before any pending
+        //   interrupt, so the SLEEP is entered with interrupts enabled and any
+        //   interrupt from here on will wake us up.
+        //
+        sleep_enable();
+        sei();
+        sleep_cpu();
+        sleep_disable();
+        }
+    }
@@ -0,0 +1,122 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2015 Peter Walsh, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      Event.h
+//
+//  SYNOPSIS
+//
+//      EventInit();                        // Called once at startup
+//
+//      PostEvent(EV_UART_RX);              // (From an ISR) Flag that something happened
+//
+//      Events = WaitEvents(EV_UART_RX);    // Sleep until one of the events is posted
+//
+//  DESCRIPTION
+//
+//      A tiny event flag dispatcher.
+//
+//      Interrupt handlers post events by setting a bit in the event flags. The
+//        main program sleeps (in SLEEP_MODE_IDLE) until one of the events it is
+//        interested in has been posted, instead of spinning on a status flag.
+//
+//      Waiting loops should look like this:
+//
+//          while( I2CBusy() )
+//              WaitEvents(EV_I2C);
+//
+//      The event only means "something changed, look again". Stale events are
+//        harmless - the loop simply checks its condition one extra time.
+//
+//  VERSION:    2026.10.17
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef EVENT_H
+#define EVENT_H
+
+#include <stdint.h>
+#include <avr/io.h>
+
+#include "PortMacros.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// The event flags are kept in GPIOR0, which is in the bit-addressable I/O space.
+//   Posting a single event compiles into one SBI instruction, so it is atomic
+//   from both interrupt and main level.
+//
+#define EVENT_FLAGS     GPIOR0
+
+#define EV_UART_RX      0x01            // UART received a char
+#define EV_UART_TX      0x02            // UART Tx FIFO has room
+#define EV_I2C          0x04            // I2C transfer finished
+#define EV_TICK         0x08            // Millisecond timer tick
+
+#define EV_ALL          0xFF
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// EventInit - Initialize event processing
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void EventInit(void);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// PostEvent - Post an event
+//
+// Inputs:      Event(s) to post (EV_xxx)
+//
+// Outputs:     None.
+//
+#define PostEvent(_e_)  _SET_MASK(EVENT_FLAGS,_e_)
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// WaitEvents - Sleep until an event is posted
+//
+// Sleep in idle mode until one of the requested events has been posted. The
+//   events returned are cleared, others are left pending.
+//
+// Inputs:      Mask of events to wait for
+//
+// Outputs:     Events that were posted (subset of mask)
+//
+// NOTE: Enables interrupts. Not callable from an ISR.
+//
+uint8_t WaitEvents(uint8_t Mask);
+
+#endif  // EVENT_H - entire file
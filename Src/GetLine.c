@@ -186,6 +186,10 @@ void PlotCursor(void) {
 // Collect chars until a terminator is seen, then pass the input 
 //   buffer to SystemCommand().
 //
+// Each completed token is offered to SerialPartial(), so that a long (pasted)
+//   command can be acted on as it arrives. Whatever it takes is gone from the line,
+//   and can no longer be backspaced over.
+//
 // Inputs:      Serial input char to process
 //
 // Outputs:     None.
@@ -252,15 +256,26 @@ void ProcessSerialInput(char InChar) {
         if( InChar == ESC ) 
             strcpy(LineBuffer,ESC_CMD);
 
-        SerialCommand(LineBuffer);
+        bool Done = SerialCommand(LineBuffer);
         InitLineBuffer();
-        Prompt();
+        if( Done )
+            Prompt();
         return;
         }
     else if (InChar == '\n')               // Do not add \n characters to
         return;                            // LineBuffer.
 
 
+    //
+    // A delimiter after a token completes it
+    //
+    if( (InChar == ' ' || InChar == '\t') && nChars != 0 &&
+        LineBuffer[nChars-1] != ' '    && LineBuffer[nChars-1] != '\t' &&
+        SerialPartial(LineBuffer) ) {
+        InitLineBuffer();
+        return;
+        }
+
     //
     // Not a TERMINATOR character, must be part of a COMMAND.  Add it to the
     //   line buffer string if there is room.
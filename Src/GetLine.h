@@ -48,7 +48,17 @@
 
 #define ESC_CMD     "\033"
 
-extern void SerialCommand(char *);
+//
+// SerialCommand returns TRUE if the command is finished, FALSE if it continues
+//   running as a task (which then prints the prompt when it's done).
+//
+extern bool SerialCommand(char *);
+
+//
+// SerialPartial sees the line so far each time a token is completed, and
+//   returns TRUE if it used everything (which is then cleared from the line).
+//
+extern bool SerialPartial(char *);
 
 //
 // Define this next to avoid VT100 screen positioning and use regular line mode
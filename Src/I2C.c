@@ -23,25 +23,49 @@
 //                                              // 100  => 100 KHz speed
 //                                              // TRUE => Use internal pullups
 //
-//      uint8_t Buffer;                         // Buffer to write/read
+//      I2C_XFER Xfer;                          // Transfer descriptor
 //
-//      PutI2C (SlaveAddr,nBytes,Buffer,NoStop);// Initiate block write
-//      PutI2CW(SlaveAddr,nBytes,Buffer);       // Initiate write, wait for completion
+//      Xfer.SlaveAddr = SlaveAddr;             // 7-bit address
+//      Xfer.WrBytes   = 1;                     // Bytes to write first
+//      Xfer.WrBuffer  = &Reg;
+//      Xfer.RdBytes   = nBytes;                // Bytes to read after repeated start
+//      Xfer.RdBuffer  = Buffer;
+//      Xfer.Priority  = I2C_PRI_LOW;           // Background transfer
+//      Xfer.Flags     = I2C_SPLIT;             // Long read may be split
 //
-//      GetI2C (SlaveAddr,nBytes,Buffer);       // Initiate block read
-//      GetI2CW(SlaveAddr,nBytes,Buffer);       // Initiate read, wait for completion
+//      I2CSubmit (&Xfer);                      // Queue transfer
+//      I2CSubmitW(&Xfer);                      // Queue transfer, wait for completion
+//
+//      if( Xfer.Status != I2C_WORKING ) ...    // Transfer is done
+//
+//      I2CCancel(&Xfer);                       // Remove from queue if not started
 //
 //      if( I2CBusy() ) ...                     // TRUE if hardware in use
 //
+//      WaitEvents(EV_I2C);                     // Sleep until a transfer ends
+//
 //      void I2CISR(void) {...}                 // Process result of command
 //
 //      Status = I2CStatus();                   // Return status of last command
 //
+//      I2CGetStats(I2C_PRI_HIGH,&Stats,true);  // Get queue stats, then clear
+//
 //  DESCRIPTION
 //
 //      A simple I2C driver module for interrupt driven communications
 //        on an AVR processor.
 //
+//      Transfers are described by an I2C_XFER, and queued by priority. A
+//        transfer is an optional write, then an optional read joined to it
+//        by a repeated start (or STOP/START with I2C_STOPSTART). Nothing else
+//        gets on the bus in between, so register reads can't be disturbed.
+//
+//      High priority transfers go first. A low priority read marked I2C_SPLIT
+//        is split every I2C_CHUNK_SIZE bytes if a high priority transfer is
+//        waiting; the rest is read later by rewriting the (advanced) register
+//        address. A high priority transfer therefore waits for at most one
+//        chunk of background data, no matter how busy the background is.
+//
 //  VERSION:    2013.01.06
 //
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -70,8 +94,10 @@
 
 #include <string.h>
 #include <avr/interrupt.h>
+#include <avr/pgmspace.h>
 
 #include "PortMacros.h"
+#include "Timer.h"
 #include "I2C.h"
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -100,12 +126,53 @@ uint8_t *I2C_DebugPtr;
 //
 //////////////////////////////////////////////////////////////////////////////////////////
 
+#ifdef I2C_FIXED_SHAPES
+//
+// Handler for the shape of the transfer on the bus, NULL => general (TWIStep)
+//
+typedef void (*FIXED_STEP)(void);
+
+static FIXED_STEP FindFixed(I2C_XFER *Xfer);
+#endif
+
+//
+// Bus speed, as TWI register values
+//
+typedef struct {
+    uint8_t     Addr;                   // Slave address (profiles only)
+    uint8_t     BitRate;                // TWBR
+    uint8_t     Prescale;               // TWPS1:0
+    } I2C_SPEED;
+
 static struct {
-    uint8_t     SlaveAddr;      // Slave address
-    uint8_t     nBytes;         // Number of bytes left to process
-    uint8_t    *Buffer;         // Buffer for request
-    bool        NoStop;         // Don't send stop after request
-    I2C_STATUS  Status;         // Status of request
+    I2C_XFER   *Head[I2C_NUM_PRI];      // Queue of transfers, per priority
+    I2C_XFER   *Tail[I2C_NUM_PRI];
+    I2C_XFER   *Active;                 // Transfer on the bus, or NULL
+    I2C_XFER   *First;                  // First transfer of Active's chain
+    uint8_t     SlaveAddr;              // Slave address + R/W of current phase
+    uint8_t     nBytes;                 // Number of bytes left in phase
+    uint8_t    *Buffer;                 // Buffer for phase
+    bool        Flash;                  // Buffer is in flash
+    I2C_SEG    *Seg;                    // Current segment, or NULL
+    uint8_t     ChunkLeft;              // Bytes left in read chunk
+    uint8_t     Reg;                    // Register address of split read
+    uint16_t    PollCycles;             // Poll transfers shorter than this
+#ifdef I2C_FIXED_SHAPES
+    FIXED_STEP  Fixed;                  // Fixed shape handler, NULL => general
+#endif
+    uint32_t    BusStart;               // TimerUS() when the bus went busy
+    uint32_t    XferStart;              // TimerUS() when Active's chain started
+    bool        Timed;                  // Active's chain is being timed
+    I2C_BUSSTATS Bus;                   // Bus use stats
+    I2C_LATENCY Latency;                // Latency histograms
+    volatile bool RawBusy;              // Raw session step in progress
+    bool        RawStop;                // Send STOP when the step is done
+    I2C_STATUS  RawResult;              // Result of last raw step
+    uint8_t     RawData;                // Byte read by last raw step
+    I2C_STATUS  Status;                 // Status of last transfer
+    I2C_QSTATS  Stats[I2C_NUM_PRI];     // Queueing stats, per priority
+    I2C_SPEED   Speed;                  // Normal bus speed
+    I2C_SPEED   Profiles[I2C_PROFILES]; // Per-slave bus speeds, Addr 0 => unused
     } I2C NOINIT;
 
 //
@@ -155,6 +222,7 @@ static struct {
 #define START_I2C   _SET_MASK(TWCR,_PIN_MASK(TWINT) | _PIN_MASK(TWSTA));
 #define STOP_I2C    _SET_MASK(TWCR,_PIN_MASK(TWINT) | _PIN_MASK(TWSTO));
 #define STEP_I2C    _SET_BIT(TWCR,TWINT);
+#define STSTA_I2C   _SET_MASK(TWCR,_PIN_MASK(TWINT) | _PIN_MASK(TWSTO) | _PIN_MASK(TWSTA));
 
 #ifdef CALL_I2CISR
 extern  void I2CISR();
@@ -172,41 +240,21 @@ extern  void I2CISR();
 //
 // Outputs:     None.
 //
-void I2CInit(uint8_t KHz, uint8_t OurAddr, bool UseInternalPullups) {
+void I2CInit(uint16_t KHz, uint8_t OurAddr, bool UseInternalPullups) {
 
     memset(&I2C,0,sizeof(I2C));
 
     _CLR_BIT(PRR,PRTWI);                    // Power up the I2C
 
-    //
-    // Enable internal pullups if requested
-    //
-    if( UseInternalPullups ) {
-        _CLR_BIT(          MCUCR,     PUD); // Clear disable pullup flag
-        _SET_BIT(_PORT(TWI_PORT), SCL_BIT); // Set to enable pullups
-        _SET_BIT(_PORT(TWI_PORT), SDA_BIT); // Set to enable pullups
-        }
-    //
-    // Enable pullups if requested (above), but don't *disable* them if
-    //   not needed (that's the caller's responsibility).
-    //
-    else {
-        _CLR_BIT(_PORT(TWI_PORT), SCL_BIT); // Set to disable pullups
-        _CLR_BIT(_PORT(TWI_PORT), SDA_BIT); // Set to disable pullups
-        }
-
-    //
-    // Set bitrate in KHz.
-    //
-    _CLR_BIT(TWSR,TWPS0);       // Prescaler => 1
-    _CLR_BIT(TWSR,TWPS1);
-
-    TWBR = (F_CPU/(1000*KHz) - 16)/2;
+    I2CSetPullups(UseInternalPullups);
+    I2CSetSpeed(KHz);
 
     //
     // Enable TWI (two-wire interface), enable interrupts
     //
-    I2C.Status = I2C_COMPLETE;
+    I2C.Status     = I2C_COMPLETE;
+    I2C.PollCycles = I2C_POLL_CYCLES;
+    I2C.Bus.Since  = TimerMS();
 
     _SET_BIT(TWCR,TWEN);        // Enable TWI
     _SET_BIT(TWCR,TWIE);        // Enable Interrupts
@@ -221,273 +269,1431 @@ void I2CInit(uint8_t KHz, uint8_t OurAddr, bool UseInternalPullups) {
     }
 
 
-///////////////////////////////////////////////////////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
 //
-// PutI2C - Initiate block write to I2C port
+// SpeedBits   - Work out the TWI register values for a bus speed
+// I2CSetSpeed - Set bus speed
 //
-// Inputs:      Slave address
-//              Number of bytes to write
-//              Ptr to data to write
-//              TRUE if should not send STOP after operation complete.
+// SCL = F_CPU/(16 + 2*TWBR*Prescale), and TWBR is only 8 bits, so slow speeds
+//   need the prescaler (1, 4, 16, or 64).
+//
+// Inputs:      Speed, in KHz
+//              Where to put the register values (SpeedBits only)
 //
 // Outputs:     None.
 //
-void PutI2C(uint8_t SlaveAddr, uint8_t nBytes,uint8_t *Buffer, bool NoStop) {
+static void SpeedBits(uint16_t KHz, I2C_SPEED *Speed) {
+    uint32_t Div = F_CPU/(1000UL*KHz);
 
-    //
-    // Send start signal and wait for response.
-    //
-    I2C.SlaveAddr = SlaveAddr << 1;         // Low order bit clr ==> Write
-    I2C.nBytes    = nBytes;
-    I2C.Buffer    = Buffer;
-    I2C.Status    = I2C_WORKING;
-    I2C.NoStop    = NoStop;
+    Div = Div > 16 ? (Div - 16)/2 : 0;
 
-    INIT_DEBUG;
+    Speed->Prescale = 0;
+    while( Div > 255 && Speed->Prescale < 3 ) {
+        Div >>= 2;
+        Speed->Prescale++;
+        }
 
-    START_I2C;
+    Speed->BitRate = Div > 255 ? 255 : Div;
     }
 
+void I2CSetSpeed(uint16_t KHz) {
 
-///////////////////////////////////////////////////////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////////////////////////
+    SpeedBits(KHz,&I2C.Speed);
+
+    TWBR = I2C.Speed.BitRate;
+    TWSR = I2C.Speed.Prescale;              // TWPS1:0, the rest is read only
+    }
+
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
 //
-// GetI2C - Initiate block read from I2C port
+// I2CSetProfile - Set the bus speed for transfers to one slave
 //
 // Inputs:      Slave address
-//              Number of bytes to read
-//              Ptr to data to write
+//              Speed, in KHz (0 => remove profile, use the normal speed)
 //
-// Outputs:     None.
+// Outputs:     TRUE  if done
+//              FALSE if all I2C_PROFILES profiles are in use
 //
-void GetI2C(uint8_t SlaveAddr, uint8_t nBytes,uint8_t *Buffer) {
+bool I2CSetProfile(uint8_t SlaveAddr, uint16_t KHz) {
+    I2C_SPEED *Speed;
+    I2C_SPEED *Free     = NULL;
+    uint8_t    SaveSREG = SREG;
 
-    //
-    // Send start signal and wait for response.
-    //
-    I2C.SlaveAddr = (SlaveAddr << 1) | 1;   // Low order bit set ==> Read
-    I2C.nBytes    = nBytes;
-    I2C.Buffer    = Buffer;
-    I2C.Status    = I2C_WORKING;
+    for( Speed = I2C.Profiles; Speed < &I2C.Profiles[I2C_PROFILES]; Speed++ ) {
+        if( Speed->Addr == SlaveAddr )
+            break;
+        if( Speed->Addr == 0 && Free == NULL )
+            Free = Speed;
+        }
 
-    INIT_DEBUG;
+    if( Speed == &I2C.Profiles[I2C_PROFILES] ) {
+        if( KHz == 0 )
+            return(true);
+        if( (Speed = Free) == NULL )
+            return(false);
+        }
 
-    START_I2C;
+    cli();                                  // NextXfer() reads these
+    if( KHz == 0 )
+        Speed->Addr = 0;
+    else {
+        SpeedBits(KHz,Speed);
+        Speed->Addr = SlaveAddr;
+        }
+    SREG = SaveSREG;
+    return(true);
     }
 
 
-///////////////////////////////////////////////////////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
 //
-// I2CBusy   - Return TRUE if I2C is busy sending output
+// I2CSetPolling - Set which transfers are polled
 //
-// Inputs:      None
+// Inputs:      Bus time in CPU cycles below which a transfer is polled
 //
-// Outputs:     TRUE  if I2C is busy sending output
-//              FALSE if I2C is idle
+// Outputs:     Previous setting
+//
+uint16_t I2CSetPolling(uint16_t Cycles) {
+    uint16_t Old = I2C.PollCycles;
+
+    I2C.PollCycles = Cycles;
+    return(Old);
+    }
+
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// I2CSetPullups - Turn internal bus pullups on or off
+//
+// Inputs:      TRUE = Use internal bus pullups
+//
+// Outputs:     None.
 //
-bool I2CBusy(void) { return I2C.Status == I2C_WORKING; }
+void I2CSetPullups(bool UseInternalPullups) {
+
+    if( UseInternalPullups ) {
+        _CLR_BIT(          MCUCR,     PUD); // Clear disable pullup flag
+        _SET_BIT(_PORT(TWI_PORT), SCL_BIT); // Set to enable pullups
+        _SET_BIT(_PORT(TWI_PORT), SDA_BIT); // Set to enable pullups
+        }
+    else {
+        _CLR_BIT(_PORT(TWI_PORT), SCL_BIT); // Set to disable pullups
+        _CLR_BIT(_PORT(TWI_PORT), SDA_BIT); // Set to disable pullups
+        }
+    }
+
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////
 //
-// I2CStatus - Return status of last operation
+// SetupWrite - Setup the write phase of the active transfer
+// SetupRead  - Setup the read  phase of the active transfer
 //
-// Inputs:      None
+// A split read is resumed by writing the register address, advanced past the bytes
+//   already read.
 //
-// Outputs:     Status (could be I2C_Working, or status of last op)
+// Inputs:      None. (Uses I2C.Active)
 //
-I2C_STATUS I2CStatus(void) { return I2C.Status; }
+// Outputs:     None.
+//
+static void SetupWrite(void) {
+    I2C_XFER *Xfer = I2C.Active;
+
+    I2C.SlaveAddr = Xfer->SlaveAddr << 1;   // Low order bit clr ==> Write
+    I2C.nBytes    = Xfer->WrBytes;
+    I2C.Buffer    = Xfer->WrBuffer;
+    I2C.Flash     = (Xfer->Flags & I2C_PGM) != 0;
+    I2C.Seg       = NULL;
+
+    if( Xfer->RdDone ) {
+        I2C.Reg    = Xfer->WrBuffer[0] + Xfer->RdDone;
+        I2C.Buffer = &I2C.Reg;
+        }
+    }
+
+static void SetupRead(void) {
+    I2C_XFER *Xfer = I2C.Active;
+
+    I2C.SlaveAddr = (Xfer->SlaveAddr << 1) | SLAVE_READ;
+    I2C.nBytes    = Xfer->RdBytes - Xfer->RdDone;
+    I2C.Buffer    = Xfer->RdBuffer + Xfer->RdDone;
+    I2C.ChunkLeft = I2C_CHUNK_SIZE;
+    I2C.Seg       = NULL;
+
+    Xfer->Flags  |= I2C_READING;
+    }
+
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// SetupSeg  - Setup for the current segment of a scatter-gather transfer
+// NextSeg   - Move on to the next segment
+// MoreToRead- Return TRUE if the next segment carries on reading
+//
+// A segment in the same direction as the last just carries on. The caller sends
+//   a repeated start if the direction changed (and so SlaveAddr).
+//
+// Inputs:      None. (Uses I2C.Active and I2C.Seg)
+//
+// Outputs:     TRUE  if there is another segment, and it has been setup (NextSeg)
+//              FALSE if the list is done
+//
+static void SetupSeg(void) {
+    I2C_SEG *Seg = I2C.Seg;
+
+    I2C.Buffer = Seg->Buffer;
+    I2C.nBytes = Seg->Bytes;
+    I2C.Flash  = (Seg->Flags & I2C_SEG_PGM) != 0;
+
+    if( Seg->Flags & I2C_SEG_READ ) {
+        I2C.SlaveAddr = (I2C.Active->SlaveAddr << 1) | SLAVE_READ;
+        I2C.Active->Flags |= I2C_READING;
+        }
+    else I2C.SlaveAddr = I2C.Active->SlaveAddr << 1;
+    }
+
+static bool NextSeg(void) {
+
+    if( I2C.Seg == NULL || I2C.Seg->Bytes == 0 || I2C.Seg[1].Bytes == 0 )
+        return(false);
+
+    I2C.Seg++;
+    SetupSeg();
+    return(true);
+    }
+
+static bool MoreToRead(void) {
+    return( I2C.Seg && I2C.Seg[1].Bytes && (I2C.Seg[1].Flags & I2C_SEG_READ) );
+    }
+
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// SetupFirst - Setup the first phase of the active transfer
+//
+// Inputs:      None. (Uses I2C.Active)
+//
+// Outputs:     None.
+//
+static void SetupFirst(void) {
+    I2C_XFER *Xfer = I2C.Active;
+
+    if( Xfer->Segs ) {
+        I2C.Seg = Xfer->Segs;
+        SetupSeg();
+        }
+    else if( Xfer->WrBytes || Xfer->RdBytes == 0 ) SetupWrite();
+    else                                           SetupRead();
+    }
+
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////
 //
-// TWI_vect - TWI interrupt state machine
+// SetupVerify - Setup the next phase of a verified write
 //
-// Take the next step in whichever TWI operation is in progress.
+// After the data, the register address is written again, then the data is read
+//   back. During the readback Buffer walks the write data, for the comparison.
 //
-// Inputs:      None. (ISR)
+// Inputs:      None. (Uses I2C.Active)
 //
 // Outputs:     None.
 //
-ISR(TWI_vect) {
-    uint8_t Status = TWSR & (~(_PIN_MASK(TWPS0) | _PIN_MASK(TWPS1)));
+static void SetupVerify(void) {
+    I2C_XFER *Xfer = I2C.Active;
 
-    ADD_DEBUG(Status);
-    ADD_DEBUG(TWCR);
+    if( !(Xfer->Flags & I2C_VERIFYING) ) {
+        I2C.SlaveAddr = Xfer->SlaveAddr << 1;
+        I2C.nBytes    = 1;
+        I2C.Buffer    = Xfer->WrBuffer;
+        Xfer->Flags  |= I2C_VERIFYING;
+        return;
+        }
 
-    switch(Status) {
+    I2C.SlaveAddr = (Xfer->SlaveAddr << 1) | SLAVE_READ;
+    I2C.nBytes    = Xfer->WrBytes - 1;
+    I2C.Buffer    = Xfer->WrBuffer + 1;
+    Xfer->Flags  |= I2C_READING;
+    }
 
-        //////////////////////////////////////////////////////////////////////////////////
-        //
-        // TW_START - Start condition has been transmitted,
-        //
-        // Turn off start, send slave address
-        //
-        case TW_START:
-        case TW_REP_START:
-            TWDR = I2C.SlaveAddr;
-            _CLR_BIT(TWCR,TWSTA);           // Indirectly clears TWINT as well :-)
-            ADD_DEBUG(I2C.SlaveAddr);
-            return;
 
-        //////////////////////////////////////////////////////////////////////////////////
-        //
-        // TW_MT_SLA_ACK  - Slave acknowledged address.
-        // TW_MT_DATA_ACK - Slave received data
-        //
-        // If no [more] data to send, terminate the transfer. Otherwise, send the
-        //   next data byte.
-        //
-        case TW_MT_SLA_ACK:
-        case TW_MT_DATA_ACK:
-            //
-            // If no more bytes to send, send STOP to finish transfer.
-            //
-            if( I2C.nBytes == 0 ) {
-                I2C.Status = I2C_COMPLETE;
-                //
-                // Don't send a STOP if the caller so chooses. This allows the
-                //   caller to setup an address (via PutI2C) and immediately
-                //   read data from a slave. Such as an EEPROM.
-                //
-                // Caller will make a 2nd I2C call, resulting in a restart.
-                //
-                if( !I2C.NoStop )
-                    STOP_I2C;
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// FindSpeed - Return the bus speed for a slave, from its profile if it has one
+// SetSpeed  - Set the bus speed for a slave
+//
+// Inputs:      Slave address
+//
+// Outputs:     Speed (FindSpeed only)
+//
+static I2C_SPEED *FindSpeed(uint8_t SlaveAddr) {
+    I2C_SPEED *Speed;
 
-                ADD_DEBUG(I2C.SlaveAddr);
-#ifdef CALL_I2CISR
-                I2CISR();
-#endif
-                return;
-                }
+    for( Speed = I2C.Profiles; Speed < &I2C.Profiles[I2C_PROFILES]; Speed++ ) {
+        if( Speed->Addr == SlaveAddr && SlaveAddr != 0 )
+            return(Speed);
+        }
 
-            //
-            // Otherwise, send [more] data to the slave
-            //
-            TWDR = *I2C.Buffer++;
-            I2C.nBytes--;
-            STEP_I2C;
-            ADD_DEBUG(I2C.SlaveAddr);
-            return;
+    return(&I2C.Speed);
+    }
 
-        //////////////////////////////////////////////////////////////////////////////////
-        //
-        // TW_MT_SLA_NACK - No slave acknowledged address (transmit)
-        // TW_MR_SLA_NACK - No slave acknowledged address ( receive)
-        //
-        case TW_MT_SLA_NACK:
-        case TW_MR_SLA_NACK:
-            I2C.Status = I2C_NO_SLAVE_ACK;
-            STOP_I2C;
-            ADD_DEBUG(I2C.SlaveAddr);
-            return;
+static void SetSpeed(uint8_t SlaveAddr) {
+    I2C_SPEED *Speed = FindSpeed(SlaveAddr);
 
-        //////////////////////////////////////////////////////////////////////////////////
-        //
-        // TW_MT_DATA_NACK - Slave didn't acknowledge data (transmit)
-        //
-        case TW_MT_DATA_NACK:
-            I2C.Status = I2C_SLAVE_DATA_NACK;
-            STOP_I2C;
-            ADD_DEBUG(I2C.SlaveAddr);
-            return;
+    TWBR = Speed->BitRate;
+    TWSR = Speed->Prescale;
+    }
 
-        //////////////////////////////////////////////////////////////////////////////////
-        //
-        // TW_ARB_LOST - Arbitration lost
-        //
-        // Enter slave mode by stepping the I2C. We don't need to send a STOP, because
-        //   we've lost arbitration.
-        //
-        case TW_ARB_LOST:
-            I2C.Status = I2C_ARB_LOST;
-            STEP_I2C;
-            ADD_DEBUG(I2C.SlaveAddr);
-            return;
 
-        //////////////////////////////////////////////////////////////////////////////////
-        //
-        // TW_MR_SLA_ACK  - Slave acknowledged address
-        //
-        // Start the first read.
-        //
-        case TW_MR_SLA_ACK:
-            //
-            // Special case - if ZERO bytes are to be read, don't step the byte
-            //   reading mechanism (below). Just stop the transfer and return.
-            //
-            if( I2C.nBytes == 0 ) {
-                I2C.Status = I2C_COMPLETE;
-                STOP_I2C;
-                ADD_DEBUG(I2C.SlaveAddr);
-                return;
-                }
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// XferCycles - Return the time a transfer should take on the bus, in CPU cycles
+//
+// Each byte is 9 SCL periods, counting an address byte for each message (and
+//   each change of direction in a segment list, and the verify), at the speed
+//   of the first slave. An SCL period is 16 + 2*TWBR*Prescale CPU cycles.
+//
+// Inputs:      Transfer (first of chain)
+//
+// Outputs:     CPU cycles
+//
+static uint32_t XferCycles(I2C_XFER *Xfer) {
+    I2C_SPEED *Speed = FindSpeed(Xfer->SlaveAddr);
+    uint16_t   Bytes = 0;
 
-            //
-            // Otherwise, setup to ACK all bytes except the last, which gets NACK.
-            //
-            if( I2C.nBytes == 1 ) { _CLR_BIT(TWCR,TWEA); }  // Last byte gets NACK
-            else                  { _SET_BIT(TWCR,TWEA); }  // Enable ack of data
-            STEP_I2C;
-            ADD_DEBUG(I2C.SlaveAddr);
-            return;
+    for( ; Xfer; Xfer = Xfer->Chain ) {
+        if( Xfer->Segs ) {
+            uint8_t Dir = 0xFF;
 
-        //////////////////////////////////////////////////////////////////////////////////
-        //
-        // TW_MR_DATA_ACK  - Slave sent data, we sent ACK
-        // TW_MR_DATA_NACK - Slave sent data, we sent NACK (meaning - last data byte)
-        //
-        // If no [more] data to receive, terminate the transfer. Otherwise, start the
-        //   next read.
-        //
-        case TW_MR_DATA_ACK:
-        case TW_MR_DATA_NACK:
-            //
-            // Get the sent byte
-            //
-            *I2C.Buffer++ = TWDR;
-            I2C.nBytes--;
+            for( I2C_SEG *Seg = Xfer->Segs; Seg->Bytes; Seg++ ) {
+                if( (Seg->Flags & I2C_SEG_READ) != Dir ) {
+                    Dir = Seg->Flags & I2C_SEG_READ;
+                    Bytes++;
+                    }
+                Bytes += Seg->Bytes;
+                }
+            continue;
+            }
 
-            //
-            // Send a NACK on the last data byte
-            //
-            if( I2C.nBytes == 1 )
-                _CLR_BIT(TWCR,TWEA);
+        if( Xfer->WrBytes || Xfer->RdBytes == 0 ) Bytes += Xfer->WrBytes + 1;
+        if( Xfer->RdBytes )                       Bytes += Xfer->RdBytes + 1;
+        if( Xfer->Flags & I2C_VERIFY )            Bytes += Xfer->WrBytes + 1;
+        }
+
+    return( 9UL * Bytes * (16 + ((uint16_t) Speed->BitRate << (2*Speed->Prescale + 1))) );
+    }
 
 
-            //
-            // If no more bytes to get, send STOP to finish transfer.
-            //
-            if( I2C.nBytes == 0 ) {
-                I2C.Status = I2C_COMPLETE;
-                STOP_I2C;
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// BusFull  - Stop the bus stats
+// BusyTime - Add time the bus was held to the bus stats
+// TimeXfer - Add a finished transfer to the bus stats
+//
+// The us sums would wrap after an hour or so, and the counts sooner on a busy
+//   bus. Rather than let one wrap, or stick at its limit while the others go
+//   on, everything stops at once and Until says when. The stats then still
+//   agree with each other, for the time up to Until.
+//
+// Stretch is the time over what the bytes should take. Slaves are kept in a
+//   small table; a new one takes the place of the one with the least stretch,
+//   if it stretched more.
+//
+// Inputs:      Stats to stop or add to (BusFull, BusyTime)
+//              Time the bus was held, in us (BusyTime)
+//              Final status of transfer (TimeXfer)
+//
+// Outputs:     None.
+//
+static void BusFull(I2C_BUSSTATS *Bus) {
 
-                ADD_DEBUG(I2C.SlaveAddr);
+    Bus->Full  = true;
+    Bus->Until = TimerMS();
+    }
 
-#ifdef CALL_I2CISR
-                I2CISR();
-#endif
-                return;
-                }
+static void BusyTime(I2C_BUSSTATS *Bus, uint32_t Time) {
 
-            //
-            // Otherwise, request more data from the slave
-            //
-            STEP_I2C;
-            return;
+    if( Bus->Full )
+        return;
 
-        //////////////////////////////////////////////////////////////////////////////////
-        //
-        // TW_BUS_ERROR - [TWI] Bus error. Stop and return error
-        //
-        case TW_BUS_ERROR:
-            I2C.Status = I2C_BUS_ERROR;
-            STOP_I2C;
-            ADD_DEBUG(I2C.SlaveAddr);
-            return;
+    if( Bus->Busy > 0xFFFFFFFF - Time ) {
+        BusFull(Bus);
+        return;
         }
 
+    Bus->Busy += Time;
+    }
+
+static void TimeXfer(I2C_STATUS Status) {
+    I2C_BUSSTATS *Bus  = &I2C.Bus;
+    I2C_STRETCH  *Slave;
+    I2C_STRETCH  *Least;
+    uint32_t      Time;
+    uint32_t      Nominal;
+    uint16_t      Stretch;
+
+    if( !I2C.Timed || Status != I2C_COMPLETE || Bus->Full )
+        return;
+
+    Time    = TimerUS() - I2C.XferStart;
+    Nominal = XferCycles(I2C.First) / (F_CPU/1000000UL);
+    Stretch = Time > Nominal ? (Time - Nominal > 0xFFFF ? 0xFFFF : Time - Nominal) : 0;
+
+    if( Time > 0xFFFF )
+        Time = 0xFFFF;
+
+    Least = Bus->Slaves;
+    for( Slave = Bus->Slaves; Slave < &Bus->Slaves[I2C_STRETCH_SLAVES]; Slave++ ) {
+        if( Slave->Addr == I2C.First->SlaveAddr )
+            break;
+        if( Slave->MaxStretch < Least->MaxStretch || Slave->Addr == 0 )
+            Least = Slave;
+        }
+
+    if( Slave == &Bus->Slaves[I2C_STRETCH_SLAVES] ) {
+        Slave = NULL;
+        if( Least->Addr == 0 || Stretch > Least->MaxStretch ) {
+            Slave = Least;
+            memset(Slave,0,sizeof(*Slave));
+            Slave->Addr = I2C.First->SlaveAddr;
+            }
+        }
+
+    if( Bus->Xfers == 0xFFFF || Bus->TotalTime > 0xFFFFFFFF - Time ||
+        (Slave != NULL && (Slave->Count == 0xFFFF || Slave->Stretch > 0xFFFFFFFF - Stretch)) ) {
+        BusFull(Bus);
+        return;
+        }
+
+    Bus->Xfers++;
+    Bus->TotalTime += Time;
+    if( Time > Bus->MaxTime )
+        Bus->MaxTime = Time;
+
+    if( Slave == NULL )
+        return;
+
+    Slave->Count++;
+    Slave->Stretch += Stretch;
+    if( Stretch > Slave->MaxStretch )
+        Slave->MaxStretch = Stretch;
+    }
+
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// HistXfer - Add a finished transfer to the latency histograms
+//
+// The bucket is the position of the top bit of the latency, above bucket 0's
+//   limit, so at most I2C_HIST_BUCKETS shifts. (See I2CGetLatency for how the
+//   slaves are chosen.) A segment list is typed by the directions of its segments.
+//
+// Inputs:      None. (Uses I2C.First)
+//
+// Outputs:     None.
+//
+static void HistXfer(void) {
+    I2C_LATENCY *Lat  = &I2C.Latency;
+    I2C_XFER    *Xfer = I2C.First;
+    uint32_t     Time = (TimerUS() - Xfer->Queued) >> I2C_HIST_SHIFT;
+    uint8_t      Bucket;
+    uint8_t      Type;
+    uint8_t      i;
+
+    if( Xfer->Flags & I2C_RAW )
+        return;
+
+    for( Bucket = 0; Time && Bucket < I2C_HIST_BUCKETS-1; Bucket++ )
+        Time >>= 1;
+
+    if( Xfer->Segs ) {
+        uint8_t Dirs = 0;                   // Bit 0 write, bit 1 read
+
+        for( I2C_SEG *Seg = Xfer->Segs; Seg->Bytes; Seg++ )
+            Dirs |= (Seg->Flags & I2C_SEG_READ) ? 2 : 1;
+
+        if     ( Xfer->Chain || Dirs == 3 ) Type = I2C_LAT_COMBINED;
+        else if( Dirs == 2 )                Type = I2C_LAT_READ;
+        else                                Type = I2C_LAT_WRITE;
+        }
+    else if( Xfer->Chain )        Type = I2C_LAT_COMBINED;
+    else if( Xfer->RdBytes == 0 ) Type = I2C_LAT_WRITE;
+    else if( Xfer->WrBytes == 0 ) Type = I2C_LAT_READ;
+    else                          Type = I2C_LAT_COMBINED;
+
+    if( Lat->Types[Type].Count[Bucket] != 0xFFFF )
+        Lat->Types[Type].Count[Bucket]++;
+
+    for( i = 0; i < I2C_HIST_SLAVES; i++ ) {
+        if( Lat->Addr[i] == Xfer->SlaveAddr && Lat->Addr[i] != 0 )
+            break;
+        }
+
+    if( i == I2C_HIST_SLAVES ) {
+        for( i = 0; i < I2C_HIST_SLAVES; i++ ) {
+            if( Lat->Score[i] == 0 )
+                break;
+            }
+
+        if( i == I2C_HIST_SLAVES ) {
+            for( i = 0; i < I2C_HIST_SLAVES; i++ )
+                Lat->Score[i]--;
+            return;
+            }
+
+        Lat->Addr[i] = Xfer->SlaveAddr;
+        memset(&Lat->Slaves[i],0,sizeof(Lat->Slaves[i]));
+        }
+
+    if( Lat->Score[i] != 0xFF )
+        Lat->Score[i]++;
+
+    if( Lat->Slaves[i].Count[Bucket] != 0xFFFF )
+        Lat->Slaves[i].Count[Bucket]++;
+    }
+
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// NextXfer - Put the next queued transfer on the bus, or release the bus
+//
+// Called with interrupts off. The highest priority queue goes first; within a
+//   priority, transfers go in the order submitted.
+//
+// Inputs:      TWCR bits to end the previous transfer (TWSTO, or 0 if none)
+//
+// Outputs:     None.
+//
+static void NextXfer(uint8_t EndBits) {
+    I2C_XFER *Xfer = NULL;
+    uint8_t   Pri;
+    uint32_t  Now  = TimerUS();
+    bool      Idle = (I2C.Active == NULL);
+
+    for( Pri = 0; Pri < I2C_NUM_PRI; Pri++ ) {
+        if( (Xfer = I2C.Head[Pri]) != NULL )
+            break;
+        }
+
+    I2C.Active = Xfer;
+    I2C.First  = Xfer;
+
+    if( Xfer == NULL ) {
+        if( !Idle )
+            BusyTime(&I2C.Bus,Now - I2C.BusStart);
+#ifdef I2C_FIXED_SHAPES
+        I2C.Fixed = NULL;
+#endif
+        _SET_MASK(TWCR,_PIN_MASK(TWINT) | EndBits);
+        return;
+        }
+
+    if( Idle )
+        I2C.BusStart = Now;
+
+    //
+    // Time the transfer only if it's going out whole (not the rest of a split read)
+    //
+    I2C.XferStart = Now;
+    I2C.Timed     = !(Xfer->Flags & (I2C_STARTED | I2C_RAW));
+
+    //
+    // Note the queueing delay the first time the transfer goes out
+    //
+    if( !(Xfer->Flags & I2C_STARTED) ) {
+        I2C_QSTATS *Stats = &I2C.Stats[Pri];
+        uint32_t    Wait  = Now - Xfer->Queued;
+
+        if( Wait > 0xFFFF )
+            Wait = 0xFFFF;
+
+        Stats->Count++;
+        Stats->TotalWait += Wait;
+        if( Wait > Stats->MaxWait )
+            Stats->MaxWait = Wait;
+
+        Xfer->Flags |= I2C_STARTED;
+        }
+
+    SetupFirst();
+
+    SetSpeed(Xfer->SlaveAddr);
+
+#ifdef I2C_FIXED_SHAPES
+    I2C.Fixed = FindFixed(Xfer);
+#endif
+
+    I2C.RawBusy = (Xfer->Flags & I2C_RAW) != 0;
+    I2C.RawStop = false;
+
+    INIT_DEBUG;
+
+    //
+    // With TWSTO also set, the hardware sends STOP then START
+    //
+    _SET_MASK(TWCR,_PIN_MASK(TWINT) | _PIN_MASK(TWSTA) | EndBits);
+    }
+
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// EndXfer - Finish the active transfer and start the next
+//
+// A chained transfer which completes goes straight on to the next in the chain,
+//   which takes its place at the head of the queue. Otherwise the chain is done,
+//   and its first transfer gets the final status.
+//
+// Inputs:      Final status of transfer
+//              TWCR bits to end the transfer (TWSTO, or 0 if we lost the bus)
+//
+// Outputs:     None.
+//
+static void EndXfer(I2C_STATUS Status, uint8_t EndBits) {
+    I2C_XFER *Xfer  = I2C.Active;
+    I2C_XFER *Chain = Xfer->Chain;
+    uint8_t   Pri   = Xfer->Priority;
+
+    I2C.Head[Pri] = Xfer->Next;             // Active is always head of its queue
+
+    if( Xfer != I2C.First )
+        Xfer->Status = Status;
+
+    if( Chain && Status == I2C_COMPLETE ) {
+        Chain->Next = I2C.Head[Pri];
+        I2C.Head[Pri] = Chain;
+        if( I2C.Tail[Pri] == Xfer )
+            I2C.Tail[Pri] = Chain;
+
+        I2C.Active = Chain;
+        SetupFirst();
+        START_I2C;                          // Repeated start
+        return;
+        }
+
+    for( ; Chain; Chain = Chain->Chain )
+        Chain->Status = I2C_CANCELLED;
+
+    I2C.First->Status = Status;
+    I2C.Status        = Status;
+    PostEvent(EV_I2C);
+
+    TimeXfer(Status);
+    HistXfer();
+
+    ADD_DEBUG(I2C.SlaveAddr);
+
+#ifdef CALL_I2CISR
+    I2CISR();
+#endif
+
+    NextXfer(EndBits);
+    }
+
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// CanSplit - Return TRUE if the active read should give way at the end of this chunk
+//
+// Inputs:      None. (Uses I2C.Active)
+//
+// Outputs:     TRUE  if a higher priority transfer is waiting, and the read may be split
+//              FALSE otherwise
+//
+static bool CanSplit(void) {
+    I2C_XFER *Xfer = I2C.Active;
+
+    if( !(Xfer->Flags & I2C_SPLIT) )
+        return(false);
+
+    for( uint8_t Pri = 0; Pri < Xfer->Priority; Pri++ ) {
+        if( I2C.Head[Pri] )
+            return(true);
+        }
+
+    return(false);
+    }
+
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// ShouldPoll - Return TRUE if a transfer is short enough to poll
+//
+// Inputs:      Transfer to check
+//
+// Outputs:     TRUE  if transfer should be polled
+//              FALSE if it should be interrupt driven
+//
+static bool ShouldPoll(I2C_XFER *Xfer) {
+
+    if( Xfer->Flags & I2C_RAW )
+        return(false);
+
+    if( I2C.PollCycles == I2C_POLL_ALWAYS )
+        return(true);
+
+    return( XferCycles(Xfer) < I2C.PollCycles );
+    }
+
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// PollXfer - Run the bus by polling until a transfer is done
+//
+// The TWI interrupt is turned off, and the state machine stepped each time TWINT
+//   is set. Only the step itself runs with interrupts off, so the UART and
+//   timer carry on. Anything queued meanwhile (from an interrupt) may start
+//   behind it, and goes back to the interrupt when the transfer is done.
+//
+// The spin is limited to I2C_POLL_SLACK times the transfer's bus time, so a
+//   stretching slave or stuck bus can't hang the caller. After that the interrupt
+//   is turned back on and finishes the transfer.
+//
+// Called with interrupts off and the bus idle; returns with interrupts off.
+//
+// Inputs:      Transfer to run (already queued)
+//
+// Outputs:     None.
+//
+static void TWIRun(void);
+
+static void PollXfer(I2C_XFER *Xfer) {
+    uint32_t Limit = I2C_POLL_SLACK * (XferCycles(Xfer) / (F_CPU/1000000UL));
+    uint32_t Start;
+
+    I2C.Stats[Xfer->Priority].Polled++;
+
+    TWCR &= ~(_PIN_MASK(TWINT) | _PIN_MASK(TWIE));  // (Writing 0 to TWINT does nothing)
+    NextXfer(0);
+    Start = TimerUS();
+
+    while( Xfer->Status == I2C_WORKING ) {
+        sei();
+        while( !(TWCR & _PIN_MASK(TWINT)) && TimerUS() - Start < Limit )
+            ;
+        cli();
+        if( !(TWCR & _PIN_MASK(TWINT)) )
+            break;                              // Taking too long, interrupt finishes
+        TWIRun();
+        }
+
+    //
+    // Turning the interrupt back on must not write 1 to TWINT (which would clear
+    //   it), or a transfer started behind us loses its first step.
+    //
+    TWCR = (TWCR & ~_PIN_MASK(TWINT)) | _PIN_MASK(TWIE);
+    }
+
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// I2CSubmit - Queue a transfer
+//
+// Inputs:      Transfer to queue
+//
+// Outputs:     None.
+//
+void I2CSubmit(I2C_XFER *Xfer) {
+    uint8_t SaveSREG = SREG;
+
+    //
+    // A split needs a one byte register address to resume from. A verify needs
+    //   a register and some data, and the readback takes the place of any read.
+    //
+    // Chained reads must keep the bus, so they can't be split either. Both
+    //   read the write data back from RAM, so neither works from flash.
+    //
+    // A segment list takes the place of both buffers.
+    //
+    for( I2C_XFER *Link = Xfer; Link; Link = Link->Chain ) {
+        if( Link->Segs ) {
+            Link->WrBytes = 0;
+            Link->RdBytes = 0;
+            }
+
+        if( Link->WrBytes != 1 || Xfer->Chain || (Link->Flags & I2C_PGM) )
+            Link->Flags &= ~I2C_SPLIT;
+
+        if( Link->WrBytes < 2 || (Link->Flags & I2C_PGM) )
+            Link->Flags &= ~I2C_VERIFY;
+
+        Link->Flags   &= ~(I2C_STARTED | I2C_READING | I2C_VERIFYING);
+        Link->Priority = Xfer->Priority;
+        Link->RdDone   = 0;
+        Link->Mismatch = 0xFF;
+        Link->Status   = I2C_WORKING;
+        }
+
+    Xfer->Next   = NULL;
+    Xfer->Queued = TimerUS();
+
+    cli();
+    if( I2C.Head[Xfer->Priority] ) I2C.Tail[Xfer->Priority]->Next = Xfer;
+    else                           I2C.Head[Xfer->Priority]       = Xfer;
+    I2C.Tail[Xfer->Priority] = Xfer;
+
+    if( I2C.Active == NULL ) {
+        if( (SaveSREG & _PIN_MASK(SREG_I)) && ShouldPoll(Xfer) ) PollXfer(Xfer);
+        else                                                     NextXfer(0);
+        }
+    SREG = SaveSREG;
+    }
+
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// I2CCancel - Remove a transfer from the queue
+//
+// Inputs:      Transfer to remove
+//
+// Outputs:     TRUE  if transfer was removed
+//              FALSE if transfer is running, or wasn't queued
+//
+bool I2CCancel(I2C_XFER *Xfer) {
+    uint8_t    SaveSREG = SREG;
+    I2C_XFER **Link;
+    I2C_XFER  *Prev     = NULL;
+    bool       Removed  = false;
+
+    cli();
+    if( Xfer != I2C.Active && Xfer->Status == I2C_WORKING ) {
+        for( Link = &I2C.Head[Xfer->Priority]; *Link; Link = &(*Link)->Next ) {
+            if( *Link == Xfer ) {
+                *Link = Xfer->Next;
+                if( I2C.Tail[Xfer->Priority] == Xfer )
+                    I2C.Tail[Xfer->Priority] = Prev;
+                for( ; Xfer; Xfer = Xfer->Chain )
+                    Xfer->Status = I2C_CANCELLED;
+                Removed = true;
+                break;
+                }
+            Prev = *Link;
+            }
+        }
+    SREG = SaveSREG;
+
+    return(Removed);
+    }
+
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// I2CBusy   - Return TRUE if I2C is busy sending output
+//
+// Inputs:      None
+//
+// Outputs:     TRUE  if I2C is busy sending output
+//              FALSE if I2C is idle
+//
+bool I2CBusy(void) { return I2C.Active != NULL; }
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// I2CStatus - Return status of last operation
+//
+// Inputs:      None
+//
+// Outputs:     Status (could be I2C_Working, or status of last op)
+//
+I2C_STATUS I2CStatus(void) { return I2C.Status; }
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// I2CGetStats - Return queueing statistics for a priority class
+//
+// Inputs:      Priority class
+//              Where to put stats
+//              TRUE if stats for that class should be cleared afterwards
+//
+// Outputs:     None.
+//
+void I2CGetStats(uint8_t Priority, I2C_QSTATS *Stats, bool Clear) {
+    uint8_t SaveSREG = SREG;
+
+    cli();
+    *Stats = I2C.Stats[Priority];
+    if( Clear )
+        memset(&I2C.Stats[Priority],0,sizeof(I2C.Stats[Priority]));
+    SREG = SaveSREG;
+    }
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// I2CGetBusStats - Return bus use and clock stretching statistics
+//
+// Inputs:      Where to put stats
+//              TRUE if stats should be cleared afterwards
+//
+// Outputs:     None.
+//
+void I2CGetBusStats(I2C_BUSSTATS *Stats, bool Clear) {
+    uint8_t SaveSREG = SREG;
+
+    cli();
+    *Stats = I2C.Bus;
+
+    //
+    // A bus in use now counts up to here, and the rest goes in the next stats
+    //
+    if( I2C.Active ) {
+        uint32_t Now = TimerUS();
+
+        BusyTime(Stats,Now - I2C.BusStart);
+        if( Clear )
+            I2C.BusStart = Now;
+        }
+
+    if( Clear ) {
+        memset(&I2C.Bus,0,sizeof(I2C.Bus));
+        I2C.Bus.Since = TimerMS();
+        }
+    SREG = SaveSREG;
+    }
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// I2CGetLatency - Return latency histograms
+//
+// Inputs:      Where to put histograms
+//              TRUE if they should be cleared afterwards
+//
+// Outputs:     None.
+//
+void I2CGetLatency(I2C_LATENCY *Latency, bool Clear) {
+    uint8_t SaveSREG = SREG;
+
+    cli();
+    *Latency = I2C.Latency;
+    if( Clear )
+        memset(&I2C.Latency,0,sizeof(I2C.Latency));
+    SREG = SaveSREG;
+    }
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// I2CRawReady - Return TRUE if a raw session is ready for its next step
+//
+// Inputs:      Raw session transfer
+//
+// Outputs:     TRUE if session holds the bus and no step is in progress, or
+//                if the session has ended
+//
+bool I2CRawReady(I2C_XFER *Xfer) {
+
+    if( I2C.Active != Xfer )
+        return(Xfer->Status != I2C_WORKING);
+
+    return(!I2C.RawBusy);
+    }
+
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// I2CRawStep - Take the next step of the active raw session
+//
+// The TWI interrupt was turned off while the bus was held, so the step turns it
+//   back on.
+//
+// Inputs:      Step to take
+//              Byte to write (I2C_RAW_WRITE only)
+//
+// Outputs:     None.
+//
+void I2CRawStep(I2C_RAW_OP Op, uint8_t Byte) {
+    uint8_t Bits = _PIN_MASK(TWINT) | _PIN_MASK(TWEN) | _PIN_MASK(TWIE);
+
+    if     ( Op == I2C_RAW_START    ) Bits |= _PIN_MASK(TWSTA);
+    else if( Op == I2C_RAW_READ_ACK ) Bits |= _PIN_MASK(TWEA);
+    else if( Op == I2C_RAW_WRITE    ) TWDR  = Byte;
+
+    I2C.RawBusy = true;
+    TWCR        = Bits;
+    }
+
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// I2CRawResult - Return the result of the last step
+//
+// Inputs:      Where to put byte read
+//
+// Outputs:     I2C_COMPLETE if the step was ACKed (or a byte was read)
+//              I2C_NO_SLAVE_ACK, &c otherwise
+//
+I2C_STATUS I2CRawResult(uint8_t *Byte) {
+
+    *Byte = I2C.RawData;
+    return(I2C.RawResult);
+    }
+
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// I2CRawStop - Send STOP, end the active raw session
+//
+// If a step is still on the bus, RawISR() sends the STOP when it's done.
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void I2CRawStop(void) {
+    uint8_t SaveSREG = SREG;
+
+    cli();
+    if( I2C.Active && (I2C.Active->Flags & I2C_RAW) ) {
+        if( I2C.RawBusy )
+            I2C.RawStop = true;
+        else {
+            TWCR = _PIN_MASK(TWEN) | _PIN_MASK(TWIE);   // TWINT stays set
+            EndXfer(I2C_COMPLETE,_PIN_MASK(TWSTO));
+            }
+        }
+    SREG = SaveSREG;
+    }
+
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// RawISR - TWI interrupt for a raw session
+//
+// Note the result of the step, then hold the bus: TWINT stays set (SCL low) and
+//   the interrupt is turned off until the next step. Arbitration loss and bus
+//   errors end the session, as does an I2CRawStop() made during the step.
+//
+// Inputs:      TWI status
+//
+// Outputs:     None.
+//
+static void RawISR(uint8_t Status) {
+
+    if( Status == TW_ARB_LOST   ) { EndXfer(I2C_ARB_LOST ,0);                return; }
+    if( Status == TW_BUS_ERROR  ) { EndXfer(I2C_BUS_ERROR,_PIN_MASK(TWSTO)); return; }
+    if( I2C.RawStop             ) { EndXfer(I2C_COMPLETE ,_PIN_MASK(TWSTO)); return; }
+
+    if     ( Status == TW_MT_SLA_NACK ||
+             Status == TW_MR_SLA_NACK  ) I2C.RawResult = I2C_NO_SLAVE_ACK;
+    else if( Status == TW_MT_DATA_NACK ) I2C.RawResult = I2C_SLAVE_DATA_NACK;
+    else                                 I2C.RawResult = I2C_COMPLETE;
+
+    I2C.RawData = TWDR;
+    I2C.RawBusy = false;
+    TWCR        = _PIN_MASK(TWEN);
+    PostEvent(EV_I2C);
+    }
+
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// TWIStep - TWI interrupt state machine
+//
+// Take the next step in whichever TWI operation is in progress.
+//
+// The status codes are all multiples of 8, so switching on TWSR >> 3 gives a
+//   dense set of cases (and a jump table) with the prescaler bits shifted out.
+//
+// Inputs:      None. (ISR)
+//
+// Outputs:     None.
+//
+static void TWIStep(void) {
+    uint8_t Status = TWSR & (~(_PIN_MASK(TWPS0) | _PIN_MASK(TWPS1)));
+
+    ADD_DEBUG(Status);
+    ADD_DEBUG(TWCR);
+
+    if( I2C.Active && (I2C.Active->Flags & I2C_RAW) ) {
+        RawISR(Status);
+        return;
+        }
+
+    switch(Status >> 3) {
+
+        //////////////////////////////////////////////////////////////////////////////////
+        //
+        // TW_START - Start condition has been transmitted,
+        //
+        // Turn off start, send slave address
+        //
+        case TW_START >> 3:
+        case TW_REP_START >> 3:
+            TWDR = I2C.SlaveAddr;
+            _CLR_BIT(TWCR,TWSTA);           // Indirectly clears TWINT as well :-)
+            ADD_DEBUG(I2C.SlaveAddr);
+            return;
+
+        //////////////////////////////////////////////////////////////////////////////////
+        //
+        // TW_MT_SLA_ACK  - Slave acknowledged address.
+        // TW_MT_DATA_ACK - Slave received data
+        //
+        // If no [more] data to send, go on to the read (if any) with a repeated
+        //   start, or terminate the transfer. Otherwise, send the next data byte.
+        //
+        // A verified write goes on to rewrite the register, then read back. A
+        //   segment list goes on to the next segment.
+        //
+        case TW_MT_SLA_ACK >> 3:
+        case TW_MT_DATA_ACK >> 3:
+            if( I2C.nBytes == 0 && NextSeg() && (I2C.Seg->Flags & I2C_SEG_READ) ) {
+                if( I2C.Active->Flags & I2C_STOPSTART ) { STSTA_I2C; }  // STOP, then START
+                else                                    { START_I2C; }  // Repeated start
+                ADD_DEBUG(I2C.SlaveAddr);
+                return;
+                }
+
+            if( I2C.nBytes == 0 ) {
+                if( I2C.Active->Flags & I2C_VERIFY ) {
+                    SetupVerify();
+                    if( I2C.Active->Flags & I2C_STOPSTART ) { STSTA_I2C; }  // STOP, then START
+                    else                                    { START_I2C; }  // Repeated start
+                    ADD_DEBUG(I2C.SlaveAddr);
+                    return;
+                    }
+
+                if( I2C.Active->RdBytes > I2C.Active->RdDone ) {
+                    SetupRead();
+                    if( I2C.Active->Flags & I2C_STOPSTART ) { STSTA_I2C; }  // STOP, then START
+                    else                                    { START_I2C; }  // Repeated start
+                    ADD_DEBUG(I2C.SlaveAddr);
+                    return;
+                    }
+
+                EndXfer(I2C_COMPLETE,_PIN_MASK(TWSTO));
+                return;
+                }
+
+            //
+            // Otherwise, send [more] data to the slave
+            //
+            if( I2C.Flash ) TWDR = pgm_read_byte(I2C.Buffer++);
+            else            TWDR = *I2C.Buffer++;
+            I2C.nBytes--;
+            STEP_I2C;
+            ADD_DEBUG(I2C.SlaveAddr);
+            return;
+
+        //////////////////////////////////////////////////////////////////////////////////
+        //
+        // TW_MT_SLA_NACK - No slave acknowledged address (transmit)
+        // TW_MR_SLA_NACK - No slave acknowledged address ( receive)
+        //
+        case TW_MT_SLA_NACK >> 3:
+        case TW_MR_SLA_NACK >> 3:
+            EndXfer(I2C_NO_SLAVE_ACK,_PIN_MASK(TWSTO));
+            return;
+
+        //////////////////////////////////////////////////////////////////////////////////
+        //
+        // TW_MT_DATA_NACK - Slave didn't acknowledge data (transmit)
+        //
+        case TW_MT_DATA_NACK >> 3:
+            EndXfer(I2C_SLAVE_DATA_NACK,_PIN_MASK(TWSTO));
+            return;
+
+        //////////////////////////////////////////////////////////////////////////////////
+        //
+        // TW_ARB_LOST - Arbitration lost
+        //
+        // Enter slave mode by stepping the I2C. We don't need to send a STOP, because
+        //   we've lost arbitration.
+        //
+        case TW_ARB_LOST >> 3:
+            EndXfer(I2C_ARB_LOST,0);
+            return;
+
+        //////////////////////////////////////////////////////////////////////////////////
+        //
+        // TW_MR_SLA_ACK  - Slave acknowledged address
+        //
+        // Start the first read. The read phase is only entered with bytes to read,
+        //   so there's always at least one.
+        //
+        // Setup to ACK all bytes except the last, which gets NACK.
+        //
+        case TW_MR_SLA_ACK >> 3:
+            if( I2C.nBytes == 1 && !MoreToRead() ) { _CLR_BIT(TWCR,TWEA); }  // Last byte gets NACK
+            else                                   { _SET_BIT(TWCR,TWEA); }  // Enable ack of data
+            STEP_I2C;
+            ADD_DEBUG(I2C.SlaveAddr);
+            return;
+
+        //////////////////////////////////////////////////////////////////////////////////
+        //
+        // TW_MR_DATA_ACK  - Slave sent data, we sent ACK
+        // TW_MR_DATA_NACK - Slave sent data, we sent NACK (meaning - last data byte)
+        //
+        // If no [more] data to receive, terminate the transfer. A NACK before the
+        //   end means the read is being split: the transfer stays at the head of its
+        //   queue, and the waiting higher priority transfer goes next.
+        //
+        // A verify readback is compared against the write data instead of stored.
+        //
+        // A segment list carries on reading into the next segment, or goes back
+        //   to writing after a repeated start.
+        //
+        case TW_MR_DATA_ACK >> 3:
+        case TW_MR_DATA_NACK >> 3:
+            //
+            // Get the sent byte
+            //
+            if( I2C.Active->Flags & I2C_VERIFYING ) {
+                if( TWDR != *I2C.Buffer && I2C.Active->Mismatch == 0xFF )
+                    I2C.Active->Mismatch = I2C.Active->RdDone;
+                I2C.Buffer++;
+                }
+            else *I2C.Buffer++ = TWDR;
+            I2C.nBytes--;
+            I2C.Active->RdDone++;
+
+            if( I2C.nBytes == 0 && NextSeg() ) {
+                if( I2C.Seg->Flags & I2C_SEG_READ ) {
+                    if( I2C.nBytes == 1 && !MoreToRead() )
+                        _CLR_BIT(TWCR,TWEA);
+                    STEP_I2C;
+                    return;
+                    }
+                if( I2C.Active->Flags & I2C_STOPSTART ) { STSTA_I2C; }  // STOP, then START
+                else                                    { START_I2C; }  // Repeated start
+                return;
+                }
+
+            if( I2C.nBytes == 0 ) {
+                EndXfer(I2C.Active->Mismatch == 0xFF ? I2C_COMPLETE : I2C_VERIFY_FAILED,
+                        _PIN_MASK(TWSTO));
+                return;
+                }
+
+            if( Status == TW_MR_DATA_NACK ) {
+                I2C.Stats[I2C.Active->Priority].Splits++;
+                NextXfer(_PIN_MASK(TWSTO));
+                return;
+                }
+
+            //
+            // Send a NACK on the last data byte, or on the last byte of a chunk
+            //   if someone more important is waiting.
+            //
+            if( --I2C.ChunkLeft == 0 )
+                I2C.ChunkLeft = I2C_CHUNK_SIZE;
+
+            if( (I2C.nBytes == 1 && !MoreToRead()) || (I2C.ChunkLeft == 1 && CanSplit()) )
+                _CLR_BIT(TWCR,TWEA);
+
+            //
+            // Otherwise, request more data from the slave
+            //
+            STEP_I2C;
+            return;
+
+        //////////////////////////////////////////////////////////////////////////////////
+        //
+        // TW_BUS_ERROR - [TWI] Bus error. Stop and return error
+        //
+        case TW_BUS_ERROR >> 3:
+            EndXfer(I2C_BUS_ERROR,_PIN_MASK(TWSTO));
+            return;
+        }
+
+    }
+
+
+#ifdef I2C_FIXED_SHAPES
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// FixedStep - TWI state machine for one fixed shape read
+//
+// Always inlined into a handler per shape (below), where the slave, register and
+//   length are constants: the address and register bytes are immediates, the
+//   first ACK/NACK choice is made by the compiler, and the only thing decided
+//   at run time is whether this byte is the last. Errors, and anything else
+//   unexpected, go to the general handler, which ends the transfer.
+//
+// Inputs:      Slave address (7-bit)
+//              Register to read
+//              # bytes to read
+//
+// Outputs:     None.
+//
+static inline void FixedStep(uint8_t SlaveAddr, uint8_t Reg, uint8_t nBytes) __attribute__((always_inline));
+static inline void FixedStep(uint8_t SlaveAddr, uint8_t Reg, uint8_t nBytes) {
+    uint8_t Status = TWSR & (~(_PIN_MASK(TWPS0) | _PIN_MASK(TWPS1)));
+
+    switch(Status >> 3) {
+
+        case TW_START >> 3:
+            TWDR = SlaveAddr << 1;
+            _CLR_BIT(TWCR,TWSTA);
+            return;
+
+        case TW_MT_SLA_ACK >> 3:
+            TWDR = Reg;
+            STEP_I2C;
+            return;
+
+        case TW_MT_DATA_ACK >> 3:
+            START_I2C;                      // Repeated start
+            return;
+
+        case TW_REP_START >> 3:
+            TWDR = (SlaveAddr << 1) | SLAVE_READ;
+            _CLR_BIT(TWCR,TWSTA);
+            I2C.Buffer = I2C.Active->RdBuffer;
+            I2C.nBytes = nBytes;
+            I2C.Active->Flags |= I2C_READING;
+            return;
+
+        case TW_MR_SLA_ACK >> 3:
+            if( nBytes == 1 ) { _CLR_BIT(TWCR,TWEA); }  // Only byte gets NACK
+            else              { _SET_BIT(TWCR,TWEA); }
+            STEP_I2C;
+            return;
+
+        case TW_MR_DATA_ACK >> 3:
+        case TW_MR_DATA_NACK >> 3:
+            *I2C.Buffer++ = TWDR;
+            if( --I2C.nBytes == 0 ) {
+                I2C.Active->RdDone = nBytes;
+                EndXfer(I2C_COMPLETE,_PIN_MASK(TWSTO));
+                return;
+                }
+            if( I2C.nBytes == 1 )
+                _CLR_BIT(TWCR,TWEA);        // Last byte gets NACK
+            STEP_I2C;
+            return;
+
+        default:
+            TWIStep();
+            return;
+        }
+    }
+
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Fixed shape handlers, one per I2C_FIXED() in I2C_FIXED_SHAPES, and the table
+//   FindFixed() matches transfers against (in flash, ending with nBytes 0).
+//
+typedef struct {
+    uint8_t     SlaveAddr;
+    uint8_t     Reg;
+    uint8_t     nBytes;
+    FIXED_STEP  Step;
+    } FIXED_SHAPE;
+
+#define I2C_FIXED(_slave_,_reg_,_bytes_)                                                \
+    static void Fixed_##_slave_##_##_reg_##_##_bytes_(void) {                           \
+        FixedStep(_slave_,_reg_,_bytes_);                                               \
+        }
+
+I2C_FIXED_SHAPES
+
+#undef  I2C_FIXED
+#define I2C_FIXED(_slave_,_reg_,_bytes_)                                                \
+    { _slave_, _reg_, _bytes_, Fixed_##_slave_##_##_reg_##_##_bytes_ },
+
+static const FIXED_SHAPE FixedShapes[] PROGMEM = {
+    I2C_FIXED_SHAPES
+    { 0, 0, 0, NULL }
+    };
+
+#undef  I2C_FIXED
+
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// FindFixed - Return the fixed shape handler for a transfer
+//
+// A fixed handler never splits a read, so an I2C_SPLIT read longer than a chunk
+//   (which might be split) stays with the general one.
+//
+// Inputs:      Transfer about to go on the bus
+//
+// Outputs:     Handler for its shape, or NULL if it needs the general one
+//
+static FIXED_STEP FindFixed(I2C_XFER *Xfer) {
+    const FIXED_SHAPE *Shape;
+
+    if( Xfer->WrBytes != 1 || Xfer->RdDone != 0 || Xfer->Chain || Xfer->Segs ||
+        (Xfer->Flags & (I2C_VERIFY | I2C_STOPSTART | I2C_PGM | I2C_RAW)) ||
+        ((Xfer->Flags & I2C_SPLIT) && Xfer->RdBytes > I2C_CHUNK_SIZE) )
+        return(NULL);
+
+    for( Shape = FixedShapes; pgm_read_byte(&Shape->nBytes) != 0; Shape++ ) {
+        if( pgm_read_byte(&Shape->SlaveAddr) == Xfer->SlaveAddr    &&
+            pgm_read_byte(&Shape->Reg)       == Xfer->WrBuffer[0]  &&
+            pgm_read_byte(&Shape->nBytes)    == Xfer->RdBytes )
+            return((FIXED_STEP) pgm_read_ptr(&Shape->Step));
+        }
+
+    return(NULL);
+    }
+#endif  // I2C_FIXED_SHAPES
+
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// TWIRun - Take the next step, in the handler for the active transfer's shape
+//
+// Without fixed shapes there's only the general handler, and no test to make.
+//
+// Inputs:      None. (ISR)
+//
+// Outputs:     None.
+//
+static void TWIRun(void) {
+
+#ifdef I2C_FIXED_SHAPES
+    if( I2C.Fixed ) I2C.Fixed();
+    else            TWIStep();
+#else
+    TWIStep();
+#endif
+    }
+
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// TWI_vect - TWI interrupt
+//
+// Inputs:      None. (ISR)
+//
+// Outputs:     None.
+//
+ISR(TWI_vect) {
+
+    TWIRun();
     }
@@ -24,25 +24,145 @@
 //                                              // Our slave address
 //                                              // TRUE => Use internal pullups
 //
-//      uint8_t Bytes;                          // Buffer to write/read
+//      I2C_XFER Xfer;                          // Transfer descriptor
 //
-//      PutI2C (SlaveAddr,nBytes,Bytes,NoStop); // Initiate block write
-//      PutI2CW(SlaveAddr,nBytes,Bytes);        // Initiate write, wait for completion
+//      Xfer.SlaveAddr = SlaveAddr;             // 7-bit address
+//      Xfer.WrBytes   = 1;                     // Bytes to write first
+//      Xfer.WrBuffer  = &Reg;
+//      Xfer.RdBytes   = nBytes;                // Bytes to read after repeated start
+//      Xfer.RdBuffer  = Buffer;
+//      Xfer.Priority  = I2C_PRI_LOW;           // Background transfer
+//      Xfer.Flags     = I2C_SPLIT;             // Long read may be split
+//      Xfer.Chain     = NULL;                  // No more messages
 //
-//      GetI2C (SlaveAddr,nBytes,Bytes);        // Initiate block read
-//      GetI2CW(SlaveAddr,nBytes,Bytes);        // Initiate read, wait for completion
+//      I2CSubmit (&Xfer);                      // Queue transfer
+//      I2CSubmitW(&Xfer);                      // Queue transfer, wait for completion
+//
+//      if( Xfer.Status != I2C_WORKING ) ...    // Transfer is done
+//
+//      I2CCancel(&Xfer);                       // Remove from queue if not started
 //
 //      if( I2CBusy() ) ...                     // TRUE if hardware in use
 //
+//      WaitEvents(EV_I2C);                     // Sleep until a transfer ends
+//
 //      void I2CISR(void) {...}                 // Process result of command
 //
 //      Status = I2CStatus();                   // Return status of last command
 //
+//      I2CGetStats(I2C_PRI_HIGH,&Stats,true);  // Get queue stats, then clear
+//      I2CGetBusStats(&BusStats,true);         // Bus use and clock stretching
+//      I2CGetLatency(&Latency,true);           // Latency histograms
+//
+//      I2CSetSpeed(400);                       // Change bus speed, in KHz
+//      I2CSetPullups(false);                   // Turn internal pullups off
+//
+//      Xfer.Flags = I2C_RAW;                   // Raw session: hold the bus
+//      I2CSubmit(&Xfer);
+//      while( !I2CRawReady(&Xfer) ) ...        // Wait for START (or step) done
+//      I2CRawStep(I2C_RAW_WRITE,Byte);         // Next step: write, read, restart
+//      Status = I2CRawResult(&Byte);           // Result of step
+//      I2CRawStop();                           // STOP, release the bus
+//
+//      I2CSetProfile(SlaveAddr,KHz);           // Slave has its own bus speed
+//      I2CSetPolling(Cycles);                  // Poll transfers shorter than this
+//
+//      Xfer.WrBuffer = (uint8_t *) Table;      // PROGMEM write data
+//      Xfer.Flags    = I2C_PGM;
+//
+//      I2C_SEG Segs[] = {                      // Scatter-gather list
+//          { Addr, 2, 0            },          // Write 2 byte address,
+//          { Data, n, I2C_SEG_PGM  },          //   then data from flash
+//          { Buf,  m, I2C_SEG_READ },          // Repeated start, read
+//          { NULL, 0, 0            },          // End of list
+//          };
+//      Xfer.Segs = Segs;                       // NULL => WrBuffer/RdBuffer
+//
+//      I2C_FIXED(0x68,0x3B,6)                  // In I2C_FIXED_SHAPES: compiled
+//                                              //   handler for this read
+//
 //  DESCRIPTION
 //
 //      A simple I2C driver module for interrupt driven communications
 //        on an AVR processor.
 //
+//      Transfers are described by an I2C_XFER, and queued by priority. A
+//        transfer is an optional write, then an optional read joined to it
+//        by a repeated start (or STOP/START with I2C_STOPSTART). Nothing else
+//        gets on the bus in between, so register reads can't be disturbed.
+//
+//      Longer transactions chain more transfers on with Chain. Each one follows
+//        the last after a repeated start, from the interrupt handler, and STOP
+//        only comes at the end. Only the first is submitted; its Status is set
+//        when the whole chain is done (the error of the transfer which failed,
+//        if any), and the ones after a failure are I2C_CANCELLED. Chained reads
+//        are never split.
+//
+//      High priority transfers go first. A low priority read marked I2C_SPLIT
+//        is split every I2C_CHUNK_SIZE bytes if a high priority transfer is
+//        waiting; the rest is read later by rewriting the (advanced) register
+//        address. A high priority transfer therefore waits for at most one
+//        chunk of background data, no matter how busy the background is.
+//
+//      A write marked I2C_VERIFY (register, then data) is read back in the
+//        same transfer: after the data the register is written again and the
+//        data read after a repeated start, each byte compared in the interrupt
+//        handler as it arrives. A mismatch gives I2C_VERIFY_FAILED, with the
+//        first bad data byte in Mismatch.
+//
+//      A transfer marked I2C_RAW is a raw session, for byte-at-a-time host
+//        protocols (see BusPirate.h). When it reaches the bus the driver sends
+//        START and then holds the bus (SCL low) between steps, each one given
+//        by the caller. Everything else waits until I2CRawStop(). The TWI has
+//        to know whether to ACK a byte before reading it, so reads say which.
+//
+//      Slow or fast slaves can have a profile, which sets the bus speed for
+//        transfers to them; everything else runs at the I2CSetSpeed() speed. A
+//        chain runs at the speed of its first slave.
+//
+//      The driver keeps track of how much of the time the bus is in use, and
+//        times each transfer against what its bytes should take at its speed;
+//        the difference estimates how long the slave stretched the clock (see
+//        I2CGetBusStats).
+//
+//      Interrupts cost more than they save on a short, fast transfer: the bus
+//        is done in a few tens of microseconds, and the entry and exit of an
+//        interrupt per byte, then waking the task which waits on it, take
+//        longer than the bytes. A short transfer submitted with the bus idle
+//        (and interrupts on, so not from an interrupt handler) is instead run
+//        polled: I2CSubmit() drives the same state machine by spinning on
+//        TWINT, with interrupts masked only while it takes each step, and
+//        returns with the transfer done (or, if it runs well over its bus time,
+//        hands it to the interrupt). Transfers queued meanwhile go back to the
+//        interrupt. Raw sessions are never polled.
+//
+//      A transfer marked I2C_PGM takes its write data from flash, read by the
+//        interrupt handler as it goes out, so long constant sequences (device
+//        init) need no RAM and no copying. Flash writes can't be split or
+//        verified.
+//
+//      A transfer with Segs set is a list of segments instead: each one a
+//        buffer, a byte count, and whether it's read or written (or written
+//        from flash). The interrupt handler walks them in order. A run of
+//        segments in the same direction is one phase on the bus, and there's a
+//        repeated start (or STOP/START) where the direction changes, so an
+//        address and its data can stay in separate buffers. The list ends
+//        with a segment of zero bytes. The driver zeroes WrBytes and RdBytes,
+//        and such transfers can't be split or verified.
+//
+//      The same few register reads are often done over and over (a sensor
+//        sampled at a high rate), and the general interrupt handler spends
+//        most of its time on things those reads never use: segments, flash,
+//        verify, splitting, chains. Shapes listed in I2C_FIXED_SHAPES each get
+//        a handler of their own, compiled with the slave, register and length
+//        as constants, so that all that is left is moving the bytes and
+//        finding the last one. A transfer is run by one if it's a 1 byte
+//        write of the register then a read of nBytes with a repeated start,
+//        alone (no chain, segments, verify, STOP/START or flash). Errors go
+//        to the general handler. A fixed read can't be split, so an I2C_SPLIT
+//        read only runs in one if it's no longer than I2C_CHUNK_SIZE, and would
+//        not have been split anyway.
+//
 //  VERSION:    2014.11.06
 //
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -75,16 +195,31 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "Event.h"
+
 /////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////
 //
-// Polled mode/ISR mode depends on the next definition.
-//
-// Defined (ie - uncommented) means call I2CISR. Undefined (commented out)
-//   means don't.
+// Define this next and the interrupt handler calls I2CISR() at the end of each
+//   transfer. Undefined (commented out) means don't.
 // 
 //#define CALL_I2CISR
 
+//
+// Short transfers are polled instead of interrupt driven: the TWI is stepped by
+//   spinning on TWINT right in I2CSubmit(), which returns with the transfer done.
+//   A transfer is short if it should take less than this many CPU cycles on the
+//   bus, at its slave's speed (1 to 3 bytes at 400 KHz). 0 => never poll. Can
+//   be changed with I2CSetPolling().
+//
+// A polled transfer still going after I2C_POLL_SLACK times its bus time (a slave
+//   stretching the clock, or a stuck bus) is handed back to the interrupt, and
+//   I2CSubmit() returns with it still working.
+//
+#define I2C_POLL_CYCLES 2000
+#define I2C_POLL_ALWAYS 0xFFFF          // I2CSetPolling(): poll everything
+#define I2C_POLL_SLACK  4
+
 //
 // This is a convoluted protocol. Define "debug" below to enable an array of
 //   information to be set while operations are in progress. The main program
@@ -95,6 +230,44 @@
 //#define DEBUG_I2C
 #define I2C_DEBUG_SIZE  30  // Max # of bytes to be recorded
 
+//
+// Low priority reads marked I2C_SPLIT give way to high priority transfers every
+//   this many bytes.
+//
+#define I2C_CHUNK_SIZE  8
+
+//
+// Number of slaves which can have their own bus speed (see I2CSetProfile)
+//
+#define I2C_PROFILES    4
+
+//
+// Number of slaves whose clock stretching is tracked (see I2CGetBusStats)
+//
+#define I2C_STRETCH_SLAVES  4
+
+//
+// Latency histograms (see I2CGetLatency): number of slaves with their own, and
+//   number of buckets. Bucket 0 is under 64 us, each one after covers twice the
+//   time of the one before, and the last takes everything longer.
+//
+#define I2C_HIST_SLAVES     3
+#define I2C_HIST_BUCKETS    11
+#define I2C_HIST_SHIFT      6           // log2 of bucket 0's limit, in us
+
+//
+// Fixed shape register reads, each I2C_FIXED(SlaveAddr,Reg,nBytes). Each one is
+//   compiled into its own interrupt handler with the shape as constants, and any
+//   transfer of exactly that shape (below) runs in it instead of the general
+//   one. List the reads done thousands of times on the fixture at hand, eg for
+//   the MPU-6050 accelerometer X, Y, Z as below (further shapes follow on
+//   continuation lines).
+//
+// It ships undefined, and then none of it is compiled: no table search as each
+//   transfer starts, and no handler test on each interrupt.
+//
+//#define I2C_FIXED_SHAPES    I2C_FIXED(0x68,0x3B,6)
+
 //
 // End of user configurable options
 //
@@ -109,9 +282,109 @@ typedef enum {
     I2C_REP_START,          // Repeated start sent - internal error
     I2C_ARB_LOST,           // Arbitration lost during transfer
     I2C_BUS_ERROR,          // I2C bus error during transmission
-    I2C_LAST_ERROR = I2C_BUS_ERROR,
+    I2C_CANCELLED,          // Removed from queue before it started
+    I2C_VERIFY_FAILED,      // Readback didn't match data written
+    I2C_TIMEOUT,            // Raw session stopped by its owner, input too slow
+    I2C_LAST_ERROR = I2C_TIMEOUT,
     } I2C_STATUS;
 
+typedef enum {
+    I2C_PRI_HIGH,           // Interactive transfers
+    I2C_PRI_LOW,            // Background transfers
+    I2C_NUM_PRI,
+    } I2C_PRIORITY;
+
+//
+// Transfer flags
+//
+#define I2C_SPLIT       0x01    // Read may be split (needs 1 byte register write)
+#define I2C_STOPSTART   0x02    // Join write and read with STOP/START, not rep start
+#define I2C_VERIFY      0x04    // Read back and compare write data (1 byte register)
+#define I2C_RAW         0x08    // Raw session, steps given by I2CRawStep()
+#define I2C_PGM         0x10    // WrBuffer is in flash (PROGMEM)
+#define I2C_VERIFYING   0x20    // Data written, readback started (driver use)
+#define I2C_READING     0x40    // Write phase done, read started (driver use)
+#define I2C_STARTED     0x80    // Transfer has been on the bus (driver use)
+
+typedef enum {
+    I2C_RAW_START,          // Repeated start
+    I2C_RAW_WRITE,          // Write a byte (address or data)
+    I2C_RAW_READ_ACK,       // Read a byte, ACK it
+    I2C_RAW_READ_NACK,      // Read a byte, NACK it
+    } I2C_RAW_OP;
+
+#define I2C_SEG_READ    0x01    // Read into segment (else write from it)
+#define I2C_SEG_PGM     0x02    // Segment is in flash (PROGMEM), write only
+
+typedef struct {
+    uint8_t            *Buffer;     // Data to write, or place for data read
+    uint8_t             Bytes;      // # bytes, 0 => end of list
+    uint8_t             Flags;      // I2C_SEG_READ, &c
+    } I2C_SEG;
+
+typedef struct I2C_XFER I2C_XFER;
+
+struct I2C_XFER {
+    I2C_XFER           *Next;       // Next in queue (driver use)
+    uint8_t             SlaveAddr;  // 7-bit slave address
+    uint8_t             WrBytes;    // # bytes to write (0 => read only)
+    uint8_t            *WrBuffer;   // Data to write
+    uint8_t             RdBytes;    // # bytes to read  (0 => write only)
+    uint8_t            *RdBuffer;   // Data read
+    uint8_t             Priority;   // I2C_PRI_HIGH or I2C_PRI_LOW
+    uint8_t             Flags;      // I2C_SPLIT, &c
+    uint8_t             RdDone;     // # bytes read so far (driver use)
+    uint8_t             Mismatch;   // First data byte failing verify, 0xFF if none
+    I2C_XFER           *Chain;      // Next transfer, after repeated start (or NULL)
+    I2C_SEG            *Segs;       // Segment list, NULL => use WrBuffer/RdBuffer
+    uint32_t            Queued;     // Time submitted, in us (set by driver)
+    volatile I2C_STATUS Status;     // I2C_WORKING until done
+    };
+
+typedef struct {
+    uint16_t    Count;              // Transfers started
+    uint16_t    MaxWait;            // Worst queueing delay, in us
+    uint32_t    TotalWait;          // Sum of queueing delays, in us
+    uint16_t    Splits;             // Reads split to let a higher priority in
+    uint16_t    Polled;             // Transfers run polled, not interrupt driven
+    } I2C_QSTATS;
+
+typedef struct {
+    uint8_t     Addr;               // Slave address, 0 => unused
+    uint16_t    Count;              // Transfers to it
+    uint32_t    Stretch;            // Sum of estimated stretch, in us
+    uint16_t    MaxStretch;         // Worst estimated stretch, in us
+    } I2C_STRETCH;
+
+typedef struct {
+    uint32_t    Since;              // TimerMS() when last cleared
+    bool        Full;               // A sum was about to overflow, so stats stopped
+    uint32_t    Until;              // TimerMS() when they stopped (if Full)
+    uint32_t    Busy;               // Time we held the bus, in us
+    uint16_t    Xfers;              // Transfers timed
+    uint32_t    TotalTime;          // Sum of their times, in us
+    uint16_t    MaxTime;            // Longest, in us
+    I2C_STRETCH Slaves[I2C_STRETCH_SLAVES];
+    } I2C_BUSSTATS;
+
+typedef enum {
+    I2C_LAT_READ,           // Read only
+    I2C_LAT_WRITE,          // Write only (verified or not)
+    I2C_LAT_COMBINED,       // Write and read, chains
+    I2C_LAT_TYPES,
+    } I2C_LAT_TYPE;
+
+typedef struct {
+    uint16_t    Count[I2C_HIST_BUCKETS];    // Transfers per bucket, stops at FFFF
+    } I2C_HIST;
+
+typedef struct {
+    I2C_HIST    Types[I2C_LAT_TYPES];       // Per transfer type
+    uint8_t     Addr[I2C_HIST_SLAVES];      // Slave of each, 0 => unused
+    uint8_t     Score[I2C_HIST_SLAVES];     // How busy, to choose who's kept
+    I2C_HIST    Slaves[I2C_HIST_SLAVES];    // Per slave
+    } I2C_LATENCY;
+
 /////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -140,7 +413,48 @@ typedef enum {
 //
 // Outputs:     None.
 //
-void I2CInit(uint8_t KHz, uint8_t OurAddr, bool UseInternalPullups);
+void I2CInit(uint16_t KHz, uint8_t OurAddr, bool UseInternalPullups);
+
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+//
+// I2CSetSpeed   - Set bus speed
+// I2CSetPullups - Turn internal bus pullups on or off
+//
+// Speeds below about 30 KHz use the TWI prescaler.
+//
+// Inputs:      Speed, in KHz (I2CSetSpeed)
+//              TRUE = Use internal bus pullups (I2CSetPullups)
+//
+// Outputs:     None.
+//
+void I2CSetSpeed(uint16_t KHz);
+void I2CSetPullups(bool UseInternalPullups);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// I2CSetPolling - Set which transfers are polled
+//
+// Inputs:      Bus time in CPU cycles below which a transfer is polled
+//                (0 => never, I2C_POLL_ALWAYS => every transfer)
+//
+// Outputs:     Previous setting
+//
+uint16_t I2CSetPolling(uint16_t Cycles);
+
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+//
+// I2CSetProfile - Set the bus speed for transfers to one slave
+//
+// Inputs:      Slave address
+//              Speed, in KHz (0 => remove profile, use the normal speed)
+//
+// Outputs:     TRUE  if done
+//              FALSE if all I2C_PROFILES profiles are in use
+//
+bool I2CSetProfile(uint8_t SlaveAddr, uint16_t KHz);
 
 /////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////
@@ -157,35 +471,48 @@ I2C_STATUS I2CStatus(void);
 //////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////
 //
-// PutI2C - Initiate block write to I2C port
+// I2CSubmit - Queue a transfer
 //
-// Inputs:      Slave address
-//              Number of bytes to write
-//              Ptr to data to write
-//              TRUE if should not send STOP after operation completes.
+// The descriptor belongs to the driver until its Status is no longer I2C_WORKING,
+//   and must not be changed or resubmitted until then.
+//
+// Inputs:      Transfer to queue
 //
 // Outputs:     None.
 //
-void PutI2C(uint8_t SlaveAddr, uint8_t nBytes,uint8_t *Bytes, bool NoStop);
+void I2CSubmit(I2C_XFER *Xfer);
 
 //////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////
 //
-// PutI2CW - Initiate block write to I2C port, wait for completion
+// I2CSubmitW - Queue a transfer, wait for completion
 //
-// Like PutI2C, but will block until complete.
+// Like I2CSubmit, but will block until complete. The processor sleeps until the
+//   TWI interrupt signals the end of the transfer.
 //
-// Inputs:      Slave address
-//              Number of bytes to write
-//              Ptr to data to write
+// Inputs:      Transfer to queue
 //
 // Outputs:     None.
 //
-#define PutI2CW(_s_,_n_,_b_,_p_)                                                \
-    { PutI2C(_s_,_n_,_b_,_p_);                                                  \
-      while( I2CBusy() );                                                       \
+#define I2CSubmitW(_x_)                                                         \
+    { I2CSubmit(_x_);                                                           \
+      while( (_x_)->Status == I2C_WORKING ) WaitEvents(EV_I2C);                 \
       }                                                                         \
 
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// I2CCancel - Remove a transfer from the queue
+//
+// A transfer which is already on the bus runs to completion.
+//
+// Inputs:      Transfer to remove
+//
+// Outputs:     TRUE  if transfer was removed (Status is I2C_CANCELLED)
+//              FALSE if transfer is running, or wasn't queued
+//
+bool I2CCancel(I2C_XFER *Xfer);
+
 //////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -194,41 +521,95 @@ void PutI2C(uint8_t SlaveAddr, uint8_t nBytes,uint8_t *Bytes, bool NoStop);
 // Inputs:      None.
 //
 // Outputs:     TRUE  if I2C is busy sending or receiving
-//              FALSE if I2C is idle
 //
 bool I2CBusy(void);
 
 //////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////
 //
-// GetI2C - Initiate block read from I2C port
+// I2CGetStats - Return queueing statistics for a priority class
 //
-// Inputs:      Slave address
-//              Number of bytes to read
-//              Ptr to data to receive buffer
+// Queueing delay is the time from I2CSubmit() until the transfer first goes
+//   out on the bus.
+//
+// Inputs:      Priority class
+//              Where to put stats
+//              TRUE if stats for that class should be cleared afterwards
 //
 // Outputs:     None.
 //
-void GetI2C(uint8_t SlaveAddr,uint8_t nBytes,uint8_t *Bytes);
+void I2CGetStats(uint8_t Priority, I2C_QSTATS *Stats, bool Clear);
 
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// I2CGetBusStats - Return bus use and clock stretching statistics
+//
+// Busy is the time from a transfer going out on an idle bus to the bus being
+//   released, so back to back transfers count as one stretch of use. Another
+//   master's transfers aren't seen.
+//
+// Each complete transfer is timed, from its START to its end, and the time
+//   it should take (9 SCL periods per byte at its speed) is taken off to give
+//   the stretch. That includes our own interrupt response to each byte, a few
+//   us, so it's the difference between slaves that tells. The slaves kept are
+//   the ones with the worst stretches. Raw sessions, split reads and failed
+//   transfers aren't timed.
+//
+// Inputs:      Where to put stats
+//              TRUE if stats should be cleared afterwards
+//
+// Outputs:     None.
+//
+void I2CGetBusStats(I2C_BUSSTATS *Stats, bool Clear);
 
 //////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////
 //
-// GetI2CW - Initiate block write to I2C port, wait for completion
+// I2CGetLatency - Return latency histograms
 //
-// Like GetI2C, but will block until complete.
+// Latency is the time from I2CSubmit() until the transfer is done, as the
+//   caller sees it: queueing, the bus, and any retries of a split read. Every
+//   transfer which reaches the bus is counted (failures too), except raw
+//   sessions, once by type and once for its slave if it has a histogram.
 //
-// Inputs:      Slave address
-//              Number of bytes to write
-//              Ptr to data to write
+// The slaves with histograms are the busiest: each transfer to one of them
+//   raises its score, and each transfer to another slave lowers all of them,
+//   and takes the place of one which has reached zero (starting afresh). A long
+//   burst to other slaves, like a scan, can push out a busy one.
+//
+// Inputs:      Where to put histograms
+//              TRUE if they should be cleared afterwards
 //
 // Outputs:     None.
 //
-#define GetI2CW(_s_,_n_,_b_)                                                    \
-    { GetI2C(_s_,_n_,_b_);                                                      \
-      while( I2CBusy() );                                                       \
-      }                                                                         \
+void I2CGetLatency(I2C_LATENCY *Latency, bool Clear);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// I2CRawReady  - Return TRUE if a raw session is ready for its next step
+// I2CRawStep   - Take the next step of the active raw session
+// I2CRawResult - Return the result of the last step
+// I2CRawStop   - Send STOP, end the active raw session
+//
+// A session which loses arbitration or sees a bus error is ended by the driver:
+//   I2CRawReady() returns TRUE, and the transfer's Status shows why.
+//
+// I2CRawStop() may be called with a step (or the START) in progress, as when
+//   a session is aborted: STOP is then sent when the step finishes.
+//
+// Inputs:      Raw session transfer (I2CRawReady)
+//              Step, and byte to write (I2CRawStep)
+//              Where to put byte read (I2CRawResult)
+//
+// Outputs:     TRUE if ready (I2CRawReady)
+//              I2C_COMPLETE if the step was ACKed, or error (I2CRawResult)
+//
+bool       I2CRawReady (I2C_XFER *Xfer);
+void       I2CRawStep  (I2C_RAW_OP Op, uint8_t Byte);
+I2C_STATUS I2CRawResult(uint8_t *Byte);
+void       I2CRawStop  (void);
 
 
 /////////////////////////////////////////////////////////////////////////////////////////
@@ -51,9 +51,21 @@
 #include <string.h>
 #include <ctype.h>
 
+#include "Event.h"
+#include "Timer.h"
+#include "Task.h"
 #include "UART.h"
 #include "Serial.h"
 #include "I2C.h"
+#include "Job.h"
+#include "Trigger.h"
+#include "Log.h"
+#include "Checksum.h"
+#include "BusPirate.h"
+#include "Config.h"
+#include "Mem.h"
+#include "Pool.h"
+#include "Init.h"
 #include "GetLine.h"
 #include "Parse.h"
 #include "VT100.h"
@@ -67,23 +79,74 @@
 //////////////////////////////////////////////////////////////////////////////////////////
 
 //
-// Our slave address, if anyone on the bus attempts to address us as a slave.
+// Max # of bytes sampled by the poller
 //
-#define OUR_I2C_ADDR    0x31
+#define MAX_POLLBYTES   8
 
-#define MAX_RWBYTES 0xF0
+//
+// A pasted W line streams to the slave as it arrives once it has STREAM_MIN data
+//   bytes. A line is taken as pasted if none of its chars came more than STREAM_GAP
+//   ms after the one before; typed lines are checked whole at EOL as usual. The bus
+//   is held at most STREAM_HOLD ms (under the SMBus 25 ms timeout) waiting for the
+//   next byte. Input waits for STREAM_ROOM bytes of room, enough for a full line of
+//   packed hex. While it waits the Rx FIFO can overflow (a slave slower than the
+//   paste), and a line which has lost chars is not streamed any further.
+//
+#define STREAM_MIN      8
+#define STREAM_GAP      4
+#define STREAM_HOLD     20
+#define STREAM_ROOM     50
+
+//
+// Column heads for the LATENCY command, the upper limit of each bucket
+//
+#if I2C_HIST_BUCKETS != 11 || I2C_HIST_SHIFT != 6
+#error "Latency buckets changed, update HistLimits in I2CCmd.c"
+#endif
+
+static const char HistLimits[I2C_HIST_BUCKETS][5] PROGMEM = {
+    "<64", "<128", "<256", "<512", "<1K", "<2K", "<4K", "<8K", "<16K", "<32K", "more" };
+
+//
+// AUTOTUNE searches between these bus speeds (KHz), until the step is less than
+//   AUTOTUNE_STEP. Each speed tried gets AUTOTUNE_READS reads, each of which must
+//   finish in AUTOTUNE_TIMEOUT ms or the search stops. The speed kept is the
+//   fastest clean one, less 1/AUTOTUNE_MARGIN of it.
+//
+#define AUTOTUNE_LOW        100
+#define AUTOTUNE_HIGH       1000
+#define AUTOTUNE_STEP       10
+#define AUTOTUNE_READS      32
+#define AUTOTUNE_TIMEOUT    20
+#define AUTOTUNE_MARGIN     10
+
+#define AUTOTUNE_FAILED     0           // Job->Errors[]: transfer failed
+#define AUTOTUNE_BAD        1           //   data didn't match the reference
+
+//
+// Reads timed in each mode by the BENCH command
+//
+#define BENCH_COUNT     100
+#define BENCH_MAX       8
+
+#define STREAM_END      0x01            // Job->Mode: line has been completed
+#define STREAM_BAD      0x02            // Job->Mode: bad data, rest of line ignored
+
+static bool     Typed;                  // Line so far has gaps, wasn't pasted
+static bool     MidLine;                // Line has been started
+static bool     Overrun;                // Line has lost chars (Rx FIFO was full)
+static uint32_t InputTime;              // When the last char was taken
 
 uint8_t SlaveAddr;
-uint8_t Buffer[MAX_RWBYTES];
 uint8_t nBytes;
 uint8_t Reg;
-uint8_t nSlaves;
-I2C_STATUS Status;
 
 uint8_t Value;
+uint16_t Word;
+uint32_t Number;
 char    *Token;
 
-uint8_t OurAddr = OUR_I2C_ADDR;
+uint32_t BootCycles;                    // Reset to ready, in CPU cycles
 
 //
 // Static layout of the help screen
@@ -91,31 +154,67 @@ uint8_t OurAddr = OUR_I2C_ADDR;
 #define HELP_SCREEN "\
 R <slave> <nBytes>                Read  data bytes from slave\r\n\
 W <slave> <Byte1> [<Byte2>] ...   Write data bytes to   slave\r\n\
+V <slave> <reg> <Byte1> ...       Write registers, read back and verify\r\n\
 S                                 Scan for slaves on bus\r\n\
 D <slave> <reg> <nBytes>          Dump slave registers starting at <reg>\r\n\
 G <slave> <reg> <nBytes>          Dump slave registers using repeated start\r\n\
+P <slave> <reg> <nBytes> <ms>     Poll slave registers every <ms> in background\r\n\
+P                                 Stop polling\r\n\
+CHECKSUM <slave> <addr> <len> [CRC32|CRC16|FLETCHER]\r\n\
+                                  Checksum slave memory (4 char addr => 2 bytes)\r\n\
+EXPECT <slave> <reg> <Byte1> ... [MASK <Mask1> ...]\r\n\
+                                  Compare registers, print PASS or bad offsets\r\n\
+XFER w<n>@<slave> <Byte1> ... r<n>[@<slave>] ...\r\n\
+                                  Combined transfer, repeated start between\r\n\
+INIT [<name> [<slave>]]           Run built in device init script, or list them\r\n\
+BENCH <slave> <nBytes>            Time reads, interrupt driven vs. polled\r\n\
+AUTOTUNE <slave> [<reg> [<nBytes>]]\r\n\
+                                  Find slave's fastest clean speed, save profile\r\n\
+\r\n\
+<command> &                       Run a bus command in background\r\n\
+JOBS                              List background jobs\r\n\
+KILL <id>                         Stop background job\r\n\
+Q                                 Show (and clear) bus queueing delays\r\n\
+BUSLOAD                           Show (and clear) bus use and clock stretching\r\n\
+LATENCY                           Show (and clear) latency histograms\r\n\
+MEM                               Show RAM use and deepest stack since reset\r\n\
+LOG                               Binary log of triggers and polling, ESC stops\r\n\
+\r\n\
+CONFIG                            Show settings (saved with CONFIG SAVE)\r\n\
+CONFIG SPEED|BAUD|ADDR <n>        Bus KHz, baud and our addr (last two at reset)\r\n\
+CONFIG PULLUPS ON|OFF             Internal bus pullups\r\n\
+CONFIG BOOT FAST|NORMAL           READY token, or banner and prompt, at reset\r\n\
+CONFIG PROFILE <slave> <KHz>      Bus speed for one slave, 0 => none\r\n\
+CONFIG SCRIPT <cmd>[;<cmd>] ...   Commands run at startup (saved now, alone)\r\n\
+CONFIG SAVE|ERASE                 Save settings, or use defaults from reset\r\n\
+\r\n\
+T                                 Show pin triggers\r\n\
+T <n> R|F|B <slave> <reg> <nBytes> Read registers on rising/falling/both edge\r\n\
+T <n> A [<reg> <nBytes>]          SMBus alert: read ARA, then responder's regs\r\n\
+T <n> OFF                         Turn trigger off\r\n\
+                                  (pin <n>: 0 => PD2, 1 => PD3, 2 => PD4)\r\n\
 \r\n\
 H           Show this help panel\r\n\
 ?           Show this help panel\r\n\
+ESC         Abort running command\r\n\
 \r\n\
 All values hex, lead 0x may be omitted.\r\n\
+Lead # for decimal, % for binary. Data may be packed: 0102A0FF.\r\n\
 Get  command uses repeated start.\r\n\
 Dump command uses full write followed by read.\r\n\
 "
 
 #define BEEP    "\007"
 
-char *StatusText[] = {
-    "I2C_COMPLETE",
-    "I2C_WORKING",
-    "I2C_NO_SLAVE_ACK",
-    "I2C_SLAVE_DATA_NACK",
-    "I2C_REP_START",
-    "I2C_MT_ARB_LOST",
-    "I2C_BUS_ERROR" };
+//
+// Fast boot sends this, then the boot time in cycles (8 hex chars), then CRLF
+//
+#define READY_TOKEN "READY "
 
 #define DS1307_ADDR 0x68
 
+static uint8_t ConsoleTask(void);
+
 //////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -131,33 +230,61 @@ int __attribute__((OS_main))  main(void) {
     //
     // Initialize the UART
     //
+    EventInit();
+    TimerInit();
     UARTInit();
-    I2CInit(100,OurAddr,true);
+    ConfigInit();                       // Baud rate, bus settings from EEPROM
+    TriggerInit();
 
     sei();                              // Enable interrupts
 
-    ClearScreen;
     //
     // End of init
     //
     //////////////////////////////////////////////////////////////////////////////////////
 
-    PrintString("I2C CMD\r\n");
-    PrintString("Type '?' for help");
-    PrintCRLF();
-    PrintCRLF();
+    //
+    // Fast boot tells the host we're ready as soon as the drivers are, with no
+    //   screen clear, banner or prompt to wait for.
+    //
+    if( Config.FastBoot ) {
+        BootCycles = TimerCycles();
+        PrintString(READY_TOKEN);
+        PrintH2(BootCycles >> 16);
+        PrintH2(BootCycles);
+        PrintCRLF();
+        }
+    else {
+        ClearScreen;
+        PrintString("I2C CMD\r\n");
+        PrintString("Type '?' for help");
+        PrintCRLF();
+        PrintCRLF();
 
-    GetLineInit();
+        GetLineInit();
+        BootCycles = TimerCycles();
+        }
 
     //////////////////////////////////////////////////////////////////////////////////////
     //
     // All done with init,
     // 
     while(1) {
+        uint8_t Ran;
+
         //
-        // Process user commands
+        // Give each task a turn. If none of them could do anything, sleep until
+        //   the next interrupt changes something.
         //
-        ProcessSerialInput(GetUARTByte());
+        Ran  = ConsoleTask();
+        Ran |= CommandTask();
+        Ran |= JobsTask();
+        Ran |= TriggerTask();
+        Ran |= LogTask();
+        Ran |= OutputTask();
+
+        if( Ran == TASK_WAITING )
+            WaitEvents(EV_ALL);
         } 
     }
 
@@ -202,56 +329,173 @@ static void DumpDebug(void) {
 //////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////
 //
-// ParseValue - Parse next token as value
+// HexDigit - Return the value of a hex char
+//
+// Inputs:      Char to convert
+//
+// Outputs:     0 to 15
+//              0xFF if not a hex char
+//
+static uint8_t HexDigit(char Char) {
+
+    if( Char >= '0' && Char <= '9' ) return(Char - '0');
+    Char |= 0x20;                                           // Lower case
+    if( Char >= 'a' && Char <= 'f' ) return(Char - 'a' + 10);
+    return(0xFF);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// ParseNumber - Parse next token as a number, up to 32 bits
+// ParseDigits - Parse a number at the start of a string
+//
+// Values are hex, with or without a lead "0x". A lead '#' means decimal, and a
+//   lead '%' binary.
+//
+// The width says how many bytes the number was written as: a hex number takes
+//   one byte per 2 chars (so "0010" is 2 bytes), decimal and binary numbers
+//   just as many as the value needs.
+//
+// A 32 bit binary number is longer than a token, so it's read straight from the
+//   line.
+//
+// ParseDigits() stops at the first char which isn't a digit, so a number can be
+//   part of a token (as in an XFER message).
 //
 // Inputs:      None (uses next token on command line)
+//              String, where to put ptr to the char after the number (ParseDigits)
 //
-// Outputs:     TRUE  if valid number token seen
-//              FALSE if some problem
+// Outputs:     Width of number in bytes (1 to 4), value in Number
+//              0 if not a number, or more than 32 bits
 //
-static bool ParseValue(void) {
+static uint8_t ParseDigits(char *Num, char **End) {
+    uint8_t  Base  = 16;
+    uint8_t  Chars = 0;
+    uint8_t  Digit;
+    uint32_t Limit;
+
+    if( Num[0]          == '0' &&
+        tolower(Num[1]) == 'x' )
+        Num += 2;
+
+    if     ( Num[0] == '#' ) { Base = 10; Num++; }
+    else if( Num[0] == '%' ) { Base =  2; Num++; }
+
+    Limit  = 0xFFFFFFFF/Base;
+    Number = 0;
+    for( ; (Digit = HexDigit(*Num)) < Base; Num++, Chars++ ) {
+        if( Number > Limit ||
+            (Number == Limit && Digit > 0xFFFFFFFF % Base) )
+            return(0);
+        Number = Number*Base + Digit;
+        }
+
+    *End = Num;
+
+    if( Chars == 0 )
+        return(0);
+
+    if( Base == 16 )
+        return((Chars+1)/2);
+
+    return(Number > 0xFFFF ? 4 : Number > 0xFF ? 2 : 1);
+    }
+
+static uint8_t ParseNumber(void) {
+    uint8_t Width;
+    char   *Num;
+
     Token = ParseToken();
+    Num   = ParseLongToken();
 
     if( Token[0]          == '0' &&
         tolower(Token[1]) == 'x' )
         Token += 2;
 
-    //
-    // For the time being, just do hex chars
-    //
-    if( strlen(Token) == 0 ||
-        strlen(Token)  > 2   )
-        return false;
+    Width = ParseDigits(Num,&Num);
 
-    if( !isxdigit(Token[0]) )
-        return false;
+    if( Width == 0 || (*Num != 0 && !isspace(*Num)) )
+        return(0);
 
-    Value = toupper(Token[0]) > '9' ? toupper(Token[0]) - 'A' + 10 : Token[0] - '0';
+    return(Width);
+    }
 
-    if( strlen(Token) == 1 )
-        return true;
 
-    if( !isxdigit(Token[1]) )
-        return false;
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// ParseValue - Parse next token as value
+//
+// Inputs:      None (uses next token on command line)
+//
+// Outputs:     TRUE  if valid number token seen
+//              FALSE if some problem
+//
+static bool ParseValue(void) {
 
-    Value <<= 4;
-    Value += toupper(Token[1]) > '9' ? toupper(Token[1]) - 'A' + 10 : Token[1] - '0';
+    if( ParseNumber() != 1 )
+        return false;
 
+    Value = Number;
     return true;
     }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// ParseBytes - Parse next token as data bytes
+//
+// Data is a single value, or a packed string of hex bytes ("0102A0FF", with or
+//   without a lead "0x") which saves typing a space between each. A packed
+//   string may be longer than a token, so it's read straight from the line.
+//
+// Inputs:      Where to put the data
+//              Room for data
+//
+// Outputs:     # bytes in token (more than room means data didn't fit)
+//              0 if not data (Token has the offending token)
+//
+static uint8_t ParseBytes(uint8_t *Buffer, uint8_t Room) {
+    char   *Hex;
+    uint8_t Count;
+
+    if( ParseNumber() == 1 ) {
+        if( Room )
+            Buffer[0] = Number;
+        return(1);
+        }
+
+    Hex = ParseLongToken();
+    if( Hex[0] == '0' && tolower(Hex[1]) == 'x' )
+        Hex += 2;
+
+    for( Count = 0; HexDigit(Hex[0]) < 16 && HexDigit(Hex[1]) < 16 && Count < 0xFF; Hex += 2 ) {
+        if( Count < Room )
+            Buffer[Count] = (HexDigit(Hex[0]) << 4) | HexDigit(Hex[1]);
+        Count++;
+        }
+
+    if( *Hex != 0 && !isspace(*Hex) )
+        return(0);
+
+    return(Count);
+    }
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////
 //
 // ParseNBytes - Parse the # bytes token
 //
-// Inputs:      None (examines next token on line)
+// Inputs:      Max # bytes allowed (size of job buffer)
 //
 // Outputs:     TRUE  if value parsed correctly
 //              FALSE if out or range or other error
 //
-static bool ParseNBytes(void) {
+static bool ParseNBytes(uint8_t Max) {
 
     if( !ParseValue() ) {
         PrintString("Unrecognized nBytes (");
@@ -262,11 +506,11 @@ static bool ParseNBytes(void) {
         return(false);
         }
 
-    if( Value > MAX_RWBYTES ) {
+    if( Value > Max ) {
         PrintString("nBytes too big (");
         PrintString(Token);
         PrintString("), must <= ");
-        PrintH(MAX_RWBYTES);
+        PrintH(Max);
         PrintString(".\r\n");
         PrintString("Type '?' for help\r\n");
         PrintCRLF();
@@ -285,258 +529,2212 @@ static bool ParseNBytes(void) {
     }
 
 
-//////////////////////////////////////////////////////////////////////////////////////////
-//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
 //
-// PrintResults - Print out a text representation of the I2C status
+// ParseWord - Parse next token as a 16 bit value
 //
-// Inputs:      TRUE if should also dump buffer (from READ or DUMP cmd)
+// Inputs:      None (uses next token on command line)
 //
-// Outputs:     None. Prints status
+// Outputs:     Width of number in bytes (1 or 2, see ParseNumber), value in Word
+//              0 if some problem
 //
-static void PrintResults(bool PrintBuffer) {
-    Status = I2CStatus();
+static uint8_t ParseWord(void) {
+    uint8_t Width = ParseNumber();
 
-    if( Status <= I2C_LAST_ERROR ) PrintString(StatusText[Status-I2C_COMPLETE]);
-    else                           PrintString("????");
-    PrintString(" (");
+    if( Width > 2 )
+        return 0;
 
-    PrintH(Status);
-    PrintString(")\r\n");
+    Word = Number;
+    return Width;
+    }
 
-    if( PrintBuffer && Status == I2C_COMPLETE ) {
-        PrintString("Data:\r\n");
-        for( int i=0; i<nBytes; i++ ) {
-            PrintString("  0x");
-            PrintH(i);
-            PrintString(": 0x");
-            PrintH(Buffer[i]);
-            PrintString("  0b");
-            PrintB(Buffer[i]);
-            PrintCRLF();
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// ParseMessage - Parse an XFER message token: r<nBytes>[@<slave>] or w<nBytes>[@<slave>]
+//
+// The slave is optional after the first message, which sets it for the rest
+//   (as in the Linux i2ctransfer command). Both are numbers as anywhere else on
+//   the command line ("w2@0x50", "r#16"), of one byte.
+//
+// Inputs:      None (examines current token)
+//
+// Outputs:     'r' or 'w', with nBytes and SlaveAddr (if given) set
+//              0 if error (error message has been printed)
+//
+static char ParseMessage(void) {
+    char  Dir = tolower(Token[0]);
+    char *Spec;
+
+    if( (Dir == 'r' || Dir == 'w') && ParseDigits(Token+1,&Spec) == 1 ) {
+        nBytes = Number;
+
+        if( *Spec == '@' ) {
+            if( ParseDigits(Spec+1,&Spec) != 1 )
+                Spec = Token;               // (Not a slave: error)
+            SlaveAddr = Number;
             }
-        PrintCRLF();
+
+        if( *Spec == 0 )
+            return(Dir);
         }
+
+    PrintString("Unrecognized message (");
+    PrintString(Token);
+    PrintString("), must r<nBytes>[@<slave>] or w<nBytes>[@<slave>].\r\n");
+    PrintString("Type '?' for help\r\n");
+    PrintCRLF();
+    return(0);
     }
 
 
-//////////////////////////////////////////////////////////////////////////////////////////
-//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
 //
-// SerialCommand - Manage command lines for this program
+// ReadJob - Read bytes from slave
 //
-// Inputs:      Command line typed by user
+// Inputs:      Job to run
 //
-// Outputs:     None.
+// Outputs:     Task state
 //
-void SerialCommand(char *Line) {
-    char    *Command;
+static uint8_t ReadJob(JOB *Job) {
 
-    ParseInit(Line);
-    Command = ParseToken();
+    TASK_BEGIN(Job->Task);
 
-    //
-    // R - Read bytes from slave
-    //
-    if( StrEQ(Command,"R") ) {
-        if( !ParseValue() ) {
-            PrintString("Unrecognized slave addr (");
-            PrintString(Token);
-            PrintString("), must 2 hex chars.\r\n");
-            PrintString("Type '?' for help\r\n");
-            PrintCRLF();
-            return;
-            }
-        SlaveAddr = Value;
+    memset(Job->Buffer,0xFF,Job->nBytes);
 
-        if( !ParseNBytes() )
-            return;
+    TASK_WAIT(Job->Task,XferIdle(Job));
+    SubmitXfer(Job,Job->SlaveAddr,0,NULL,Job->nBytes,Job->Buffer,0);
+    TASK_WAIT(Job->Task,XferIdle(Job));
+    Job->Status = Job->Xfer.Status;
 
-        memset(Buffer,0xFF,sizeof(Buffer));
-        GetI2CW(SlaveAddr,nBytes,Buffer);
-        PrintResults(true);
-        DumpDebug();
-        return;
-        }
+    TASK_WAIT(Job->Task,ReportIdle(Job));
+    PostReport(Job,NULL,Job->Status,REPORT_DATA);
+    TASK_WAIT(Job->Task,ReportDone(Job));
 
+    DumpDebug();
+    TASK_END(Job->Task);
+    }
 
-    //
-    // W - Write bytes to slave
-    //
-    if( StrEQ(Command,"W") ) {
-        if( !ParseValue() ) {
-            PrintString("Unrecognized slave addr (");
-            PrintString(Token);
-            PrintString("), must 2 hex chars.\r\n");
-            PrintString("Type '?' for help\r\n");
-            PrintCRLF();
-            return;
-            }
-        SlaveAddr = Value;
 
-        for( nBytes = 0; nBytes < MAX_RWBYTES; nBytes++ ) {
-            if( !ParseValue() )
-                break;
-            Buffer[nBytes] = Value;
-            }
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// WriteJob - Write bytes to slave (W and V commands)
+//
+// With I2C_VERIFY in Mode the driver reads the registers back and compares them,
+//   and the first byte which didn't match is reported.
+//
+// Inputs:      Job to run
+//
+// Outputs:     Task state
+//
+static uint8_t WriteJob(JOB *Job) {
+
+    TASK_BEGIN(Job->Task);
+
+    TASK_WAIT(Job->Task,XferIdle(Job));
+    SubmitXfer(Job,Job->SlaveAddr,Job->nBytes,Job->Buffer,0,NULL,Job->Mode);
+    TASK_WAIT(Job->Task,XferIdle(Job));
+    Job->Status = Job->Xfer.Status;
+
+    TASK_WAIT(Job->Task,ReportIdle(Job));
+    PostReport(Job,NULL,Job->Status,REPORT_STATUS);
+    TASK_WAIT(Job->Task,ReportDone(Job));
+
+    if( Job->Status == I2C_VERIFY_FAILED ) {
+        TASK_WAIT(Job->Task,OutputRoom() >= MAX_LINE);
+        PrintJobID(Job);
+        PrintString("First bad byte: ");
+        PrintH(Job->Xfer.Mismatch);
+        PrintString(" (reg ");
+        PrintH(Job->Buffer[0] + Job->Xfer.Mismatch);
+        PrintString(")\r\n");
+        }
 
-        if( ParseValue() ) {
-            PrintString("Too much data (");
-            PrintString(Token);
-            PrintString("), must <= ");
-            PrintH(MAX_RWBYTES);
-            PrintString(".\r\n");
-            PrintString("Type '?' for help\r\n");
-            PrintCRLF();
-            return;
-            }
+    DumpDebug();
+    TASK_END(Job->Task);
+    }
 
-        PutI2CW(SlaveAddr,nBytes,Buffer,false);
-        PrintResults(false);
-        DumpDebug();
-        return;
-        }
 
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// StreamJob - Write bytes to slave while the W line is still arriving
+//
+// The bus is held in a raw session, and bytes are sent as SerialPartial() puts them
+//   in the buffer: Index is the next byte to send, nBytes the number waiting. A
+//   failed byte stops the writing, but the rest of the line is still taken.
+//
+// If the next byte doesn't come within STREAM_HOLD ms (the paste ended, and the
+//   rest is being typed) the session is stopped with I2C_TIMEOUT, rather than hold
+//   SCL low while other masters, triggers and background jobs wait.
+//
+// Inputs:      Job to run
+//
+// Outputs:     Task state
+//
+static uint8_t StreamJob(JOB *Job) {
+    uint8_t Byte;
 
-    //
-    // S - Scan for slaves by reading register (default: Reg 0)
-    //
-    if( StrEQ(Command,"S") ) {
-        nSlaves = 0;
-        PrintString("Addr: Result\r\n");
-        for( SlaveAddr = 0; SlaveAddr <= 127; SlaveAddr++ ) {
-            GetI2CW(SlaveAddr,1,Buffer);
-            Status = I2CStatus();
-            if( Status == I2C_NO_SLAVE_ACK )
-                continue;
-            PrintH(SlaveAddr);
-            PrintString("  : ");
-            PrintString(StatusText[Status-I2C_COMPLETE]);
-            PrintCRLF();
-            if( Status != I2C_NO_SLAVE_ACK )
-                nSlaves++;
-            }
-        PrintD(nSlaves,0);
-        PrintString(" responses\r\n");
-        PrintCRLF();
-        DumpDebug();
-        return;
-        }
+    TASK_BEGIN(Job->Task);
 
+    TASK_WAIT(Job->Task,XferIdle(Job));
+    SubmitXfer(Job,Job->SlaveAddr,0,NULL,0,NULL,I2C_RAW);      // (Address for its profile)
+    TASK_WAIT(Job->Task,I2CRawReady(&Job->Xfer));
 
-    //
-    // D - Dump specified registers from device
-    //
-    if( StrEQ(Command,"D") ) {
-        if( !ParseValue() ) {
-            PrintString("Unrecognized slave addr (");
-            PrintString(Token);
-            PrintString("), must 2 hex chars.\r\n");
-            PrintString("Type '?' for help\r\n");
-            PrintCRLF();
-            return;
-            }
-        SlaveAddr = Value;
+    Job->Status = Job->Xfer.Status;
+    if( !XferIdle(Job) ) {
+        I2CRawStep(I2C_RAW_WRITE,Job->SlaveAddr << 1);
+        TASK_WAIT(Job->Task,I2CRawReady(&Job->Xfer));
+        Job->Status = XferIdle(Job) ? Job->Xfer.Status : I2CRawResult(&Byte);
+        }
 
-        if( !ParseValue() ) {
-            PrintString("Unrecognized reg (");
-            PrintString(Token);
-            PrintString("), must 2 hex chars.\r\n");
-            PrintString("Type '?' for help\r\n");
-            PrintCRLF();
-            return;
+    while(1) {
+        Job->NextTime = TimerMS() + STREAM_HOLD;
+        TASK_WAIT(Job->Task,Job->nBytes != 0 || Job->Mode != 0 ||
+                            (!XferIdle(Job) && TimerPast(Job->NextTime)));
+
+        if( Job->nBytes == 0 && Job->Mode == 0 ) {
+            I2CRawStop();
+            if( Job->Status == I2C_COMPLETE )
+                Job->Status = I2C_TIMEOUT;
+            continue;
             }
-        Reg = Value;
 
-        if( !ParseNBytes() )
-            return;
+        if( Job->nBytes == 0 || (Job->Mode & STREAM_BAD) )
+            break;
 
-        memset(Buffer,0xFF,sizeof(Buffer));
-        PutI2CW(SlaveAddr,1,&Reg,false);
-        PrintString("Write: ");
-        PrintResults(false);
-        GetI2CW(SlaveAddr,nBytes,Buffer);
-        PrintString("Read:  ");
-        PrintResults(true);
-        DumpDebug();
-        return;
+        if( Job->Status == I2C_COMPLETE ) {
+            I2CRawStep(I2C_RAW_WRITE,Job->Buffer[Job->Index]);
+            TASK_WAIT(Job->Task,I2CRawReady(&Job->Xfer));
+            Job->Status = XferIdle(Job) ? Job->Xfer.Status : I2CRawResult(&Byte);
+            }
+        Job->Index++;
+        Job->nBytes--;
         }
 
+    if( !XferIdle(Job) )
+        I2CRawStop();
 
-    //
-    // G - Get all registers using repeated start
-    //
-    if( StrEQ(Command,"D") ) {
-        if( !ParseValue() ) {
-            PrintString("Unrecognized slave addr (");
-            PrintString(Token);
-            PrintString("), must 2 hex chars.\r\n");
-            PrintString("Type '?' for help\r\n");
-            PrintCRLF();
-            return;
-            }
-        SlaveAddr = Value;
+    TASK_WAIT(Job->Task,Job->Mode & STREAM_END);
+    if( Job->Mode & STREAM_BAD )
+        TASK_EXIT(Job->Task);
 
-        if( !ParseValue() ) {
-            PrintString("Unrecognized reg (");
-            PrintString(Token);
-            PrintString("), must 2 hex chars.\r\n");
-            PrintString("Type '?' for help\r\n");
-            PrintCRLF();
-            return;
-            }
-        Reg = Value;
+    TASK_WAIT(Job->Task,ReportIdle(Job));
+    PostReport(Job,NULL,Job->Status,REPORT_STATUS);
+    TASK_WAIT(Job->Task,ReportDone(Job));
 
-        if( !ParseNBytes() )
-            return;
+    DumpDebug();
+    TASK_END(Job->Task);
+    }
 
-        memset(Buffer,0xFF,sizeof(Buffer));
-        PutI2CW(SlaveAddr,1,&Reg,true);
-        PrintString("Write: ");
-        PrintResults(false);
-        GetI2CW(SlaveAddr,nBytes,Buffer);
-        PrintString("Read:  ");
-        PrintResults(true);
-        DumpDebug();
-        return;
-        }
 
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// ScanJob - Scan for slaves by reading one byte from each address
+//
+// Each address is a separate transfer, so background jobs can run during a scan.
+//
+// Inputs:      Job to run
+//
+// Outputs:     Task state
+//
+static uint8_t ScanJob(JOB *Job) {
+
+    TASK_BEGIN(Job->Task);
 
-#ifdef DEBUG_I2C
-    //
-    // X - Do user-defined debug command
-    //
-    if( StrEQ(Command,"X") ) {
-        DumpDebug();
-        return;
-        }
-#endif
+    TASK_WAIT(Job->Task,OutputRoom() >= MAX_LINE);
+    PrintString("Addr: Result\r\n");
 
+    Job->Count = 0;
+    for( Job->Index = 0; Job->Index <= 127; Job->Index++ ) {
+        TASK_WAIT(Job->Task,XferIdle(Job));
+        SubmitXfer(Job,Job->Index,0,NULL,1,Job->Buffer,0);
+        TASK_WAIT(Job->Task,XferIdle(Job));
+        Job->Status = Job->Xfer.Status;
 
-    /////////////////////////////////////////////////////////////////////////////////////
-    //
-    // Regular commands follow
-    //
+        if( Job->Status == I2C_NO_SLAVE_ACK )
+            continue;
 
-    //
-    // HE - Help screen
-    //
-    if( StrEQ(Command,"H") ||
-        StrEQ(Command,"?" ) ) {
+        TASK_WAIT(Job->Task,OutputRoom() >= MAX_LINE);
+        PrintH(Job->Index);
+        PrintString("  : ");
+        PrintString(StatusText[Job->Status-I2C_COMPLETE]);
         PrintCRLF();
-        PrintString(HELP_SCREEN);
-        PrintCRLF();
-        return;
+        Job->Count++;
         }
 
-
-    //
-    // Not a recognized command. Let the user know he goofed.
-    //
-    PrintStringP(PSTR(BEEP));
-    PrintStringP(PSTR("Unrecognized Command \""));
-    PrintString (Command);
-    PrintStringP(PSTR("\"\r\n"));
-    PrintString("Type '?' for help\r\n");
+    TASK_WAIT(Job->Task,OutputRoom() >= MAX_LINE);
+    PrintD(Job->Count,0);
+    PrintString(" responses\r\n");
     PrintCRLF();
+
+    DumpDebug();
+    TASK_END(Job->Task);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// DumpJob - Dump slave registers (D and G commands)
+//
+// Write the register address, then read the data. With RepStart set the read
+//   follows a repeated start, otherwise a full STOP/START. Either way it's one
+//   transfer, so nothing else can move the register pointer in between.
+//
+// If the write fails the read isn't attempted, and only the write is reported.
+//
+// Inputs:      Job to run
+//
+// Outputs:     Task state
+//
+static uint8_t DumpJob(JOB *Job) {
+
+    TASK_BEGIN(Job->Task);
+
+    memset(Job->Buffer,0xFF,Job->nBytes);
+
+    TASK_WAIT(Job->Task,XferIdle(Job));
+    SubmitXfer(Job,Job->SlaveAddr,1,&Job->Reg,Job->nBytes,Job->Buffer,
+               I2C_SPLIT | (Job->RepStart ? 0 : I2C_STOPSTART));
+    TASK_WAIT(Job->Task,XferIdle(Job));
+    Job->Status = Job->Xfer.Status;
+
+    TASK_WAIT(Job->Task,ReportIdle(Job));
+    if( Job->Xfer.Flags & I2C_READING ) {
+        PostReport(Job,PSTR("Write: "),I2C_COMPLETE,REPORT_STATUS);
+        TASK_WAIT(Job->Task,ReportIdle(Job));
+        PostReport(Job,PSTR("Read:  "),Job->Status,REPORT_DATA);
+        }
+    else PostReport(Job,PSTR("Write: "),Job->Status,REPORT_STATUS);
+    TASK_WAIT(Job->Task,ReportDone(Job));
+
+    DumpDebug();
+    TASK_END(Job->Task);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// ChecksumJob - Checksum a block of slave memory (CHECKSUM command)
+//
+// The block is read a buffer at a time, each read starting with its own address
+//   write, and each buffer is added to the checksum as it arrives. Only the
+//   result is printed, so a large part costs bus time and not serial time.
+//
+// Inputs:      Job to run
+//
+// Outputs:     Task state
+//
+static uint8_t ChecksumJob(JOB *Job) {
+
+    TASK_BEGIN(Job->Task);
+
+    Job->Sum = CheckStart(Job->Mode);
+
+    while( Job->Left ) {
+        Job->nBytes     = Job->Left < Job->Size ? Job->Left : Job->Size;
+        Job->AddrBuf[0] = Job->Addr >> 8;
+        Job->AddrBuf[1] = Job->Addr;
+
+        TASK_WAIT(Job->Task,XferIdle(Job));
+        SubmitXfer(Job,Job->SlaveAddr,Job->AddrBytes,&Job->AddrBuf[2-Job->AddrBytes],
+                   Job->nBytes,Job->Buffer,Job->AddrBytes == 1 ? I2C_SPLIT : 0);
+        TASK_WAIT(Job->Task,XferIdle(Job));
+        Job->Status = Job->Xfer.Status;
+
+        if( Job->Status != I2C_COMPLETE )
+            break;
+
+        Job->Sum   = CheckAdd(Job->Mode,Job->Sum,Job->Buffer,Job->nBytes);
+        Job->Addr += Job->nBytes;
+        Job->Left -= Job->nBytes;
+        }
+
+    TASK_WAIT(Job->Task,OutputRoom() >= MAX_LINE);
+    PrintJobID(Job);
+
+    if( Job->Status != I2C_COMPLETE ) {
+        PrintString("Read at 0x");
+        PrintH2(Job->Addr);
+        PrintString(": ");
+        PrintStatus(Job->Status);
+        }
+    else {
+        Job->Sum = CheckEnd(Job->Mode,Job->Sum);
+        if( Job->Mode == CHECK_CRC32 ) {
+            PrintString("CRC32: 0x");
+            PrintH2(Job->Sum >> 16);
+            }
+        else if( Job->Mode == CHECK_CRC16 ) PrintString("CRC16: 0x");
+        else                                PrintString("FLETCHER: 0x");
+        PrintH2(Job->Sum);
+        PrintCRLF();
+        PrintCRLF();
+        }
+
+    TASK_END(Job->Task);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// ExpectJob - Compare slave registers against expected values (EXPECT command)
+//
+// The buffer holds the data read, then the expected values, then the masks,
+//   nBytes each. Only bits set in the mask are compared. Prints "PASS", or
+//   "FAIL" and the offsets of the bytes which didn't match.
+//
+// Inputs:      Job to run
+//
+// Outputs:     Task state
+//
+static uint8_t ExpectJob(JOB *Job) {
+
+    TASK_BEGIN(Job->Task);
+
+    TASK_WAIT(Job->Task,XferIdle(Job));
+    SubmitXfer(Job,Job->SlaveAddr,1,&Job->Reg,Job->nBytes,Job->Buffer,I2C_SPLIT);
+    TASK_WAIT(Job->Task,XferIdle(Job));
+    Job->Status = Job->Xfer.Status;
+
+    TASK_WAIT(Job->Task,OutputRoom() >= MAX_LINE);
+    PrintJobID(Job);
+
+    if( Job->Status != I2C_COMPLETE ) {
+        PrintString("FAIL ");
+        PrintStatus(Job->Status);
+        TASK_EXIT(Job->Task);
+        }
+
+    Job->Count = 0;
+    for( Job->Index = 0; Job->Index < Job->nBytes; Job->Index++ ) {
+        if( ((Job->Buffer[Job->Index] ^ Job->Buffer[Job->Index+Job->nBytes]) &
+              Job->Buffer[Job->Index+2*Job->nBytes]) == 0 )
+            continue;
+
+        if( Job->Count++ == 0 )
+            PrintString("FAIL");
+
+        TASK_WAIT(Job->Task,OutputRoom() >= 3);
+        PrintChar(' ');
+        PrintH(Job->Index);
+        }
+
+    if( Job->Count == 0 )
+        PrintString("PASS");
+    PrintCRLF();
+
+    TASK_END(Job->Task);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// XferJob - Run a combined transfer (XFER command)
+//
+// The messages were set up as a chain of transfers when the command was parsed.
+//   Afterwards the data read is gathered at the front of the buffer for printing.
+//
+// Inputs:      Job to run
+//
+// Outputs:     Task state
+//
+static uint8_t XferJob(JOB *Job) {
+    I2C_XFER *Link;
+
+    TASK_BEGIN(Job->Task);
+
+    TASK_WAIT(Job->Task,XferIdle(Job));
+    SubmitChain(Job);
+    TASK_WAIT(Job->Task,XferIdle(Job));
+    Job->Status = Job->Xfer.Status;
+
+    //
+    // The first transfer has the status of the chain, so the one which failed
+    //   is the first after it with an error of its own.
+    //
+    Job->nBytes = 0;
+    Job->Count  = 0;
+    Job->Index  = Job->Status == I2C_COMPLETE ? 0 : 1;
+    for( Link = &Job->Xfer; Link; Link = Link->Chain ) {
+        Job->Count++;
+        if( Link != &Job->Xfer && Link->Status != I2C_COMPLETE &&
+                                  Link->Status != I2C_CANCELLED )
+            Job->Index = Job->Count;
+        memmove(&Job->Buffer[Job->nBytes],Link->RdBuffer,Link->RdBytes);
+        Job->nBytes += Link->RdBytes;
+        }
+
+    TASK_WAIT(Job->Task,ReportIdle(Job));
+    PostReport(Job,NULL,Job->Status,Job->Status == I2C_COMPLETE && Job->nBytes ?
+                                    REPORT_DATA : REPORT_STATUS);
+    TASK_WAIT(Job->Task,ReportDone(Job));
+
+    if( Job->Index ) {
+        TASK_WAIT(Job->Task,OutputRoom() >= MAX_LINE);
+        PrintJobID(Job);
+        PrintString("Failed at message ");
+        PrintD(Job->Index,0);
+        PrintCRLF();
+        }
+
+    DumpDebug();
+    TASK_END(Job->Task);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// InitJob - Run a device init script from flash (INIT command)
+//
+// Each write goes out straight from flash. The script stops at the first write
+//   which fails. With a slave given (SlaveAddr not 0xFF) every write goes there
+//   instead of to the script's own addresses.
+//
+// After an INIT_PREFIX step, the prefix byte (kept in AddrBuf) goes ahead of each
+//   write as a segment of its own, with the data following from flash. The
+//   segment list is at the front of the job's buffer, which INIT doesn't use.
+//
+// Op is only used between waits (locals don't survive one); the write's length
+//   is kept in nBytes.
+//
+// Inputs:      Job to run
+//
+// Outputs:     Task state
+//
+static uint8_t InitJob(JOB *Job) {
+    I2C_SEG *Segs = (I2C_SEG *) Job->Buffer;
+    uint8_t  Op;
+
+    TASK_BEGIN(Job->Task);
+
+    Job->Count     = 0;
+    Job->AddrBytes = 0;
+    Job->Status    = I2C_COMPLETE;
+
+    TASK_WAIT(Job->Task,XferIdle(Job));
+
+    while( (Op = pgm_read_byte(Job->Script++)) != INIT_OP_END ) {
+
+        if( Op == INIT_OP_DELAY ) {
+            Job->NextTime = TimerMS() + pgm_read_byte(Job->Script++);
+            TASK_WAIT(Job->Task,TimerPast(Job->NextTime));
+            continue;
+            }
+
+        if( Op == INIT_OP_PREFIX ) {
+            Job->AddrBuf[0] = pgm_read_byte(Job->Script++);
+            Job->AddrBytes  = 1;
+            continue;
+            }
+
+        Job->nBytes = pgm_read_byte(Job->Script++);
+        Job->Count++;
+
+        if( Job->AddrBytes == 0 )
+            SubmitXfer(Job,Job->SlaveAddr == 0xFF ? Op : Job->SlaveAddr,
+                       Job->nBytes,(uint8_t *) Job->Script,0,NULL,I2C_PGM);
+        else {
+            Segs[0].Buffer = Job->AddrBuf;
+            Segs[0].Bytes  = Job->AddrBytes;
+            Segs[0].Flags  = 0;
+            Segs[1].Buffer = (uint8_t *) Job->Script;
+            Segs[1].Bytes  = Job->nBytes;
+            Segs[1].Flags  = I2C_SEG_PGM;
+            Segs[2].Bytes  = 0;
+
+            Job->Xfer.SlaveAddr = Job->SlaveAddr == 0xFF ? Op : Job->SlaveAddr;
+            Job->Xfer.Flags     = 0;
+            Job->Xfer.Chain     = NULL;
+            Job->Xfer.Segs      = Segs;
+            SubmitChain(Job);
+            }
+        Job->Script += Job->nBytes;
+        TASK_WAIT(Job->Task,XferIdle(Job));
+        if( (Job->Status = Job->Xfer.Status) != I2C_COMPLETE )
+            break;
+        }
+
+    TASK_WAIT(Job->Task,ReportIdle(Job));
+    PostReport(Job,NULL,Job->Status,REPORT_STATUS);
+    TASK_WAIT(Job->Task,ReportDone(Job));
+
+    if( Job->Status != I2C_COMPLETE ) {
+        TASK_WAIT(Job->Task,OutputRoom() >= MAX_LINE);
+        PrintJobID(Job);
+        PrintString("Failed at write ");
+        PrintD(Job->Count,0);
+        PrintCRLF();
+        }
+
+    DumpDebug();
+    TASK_END(Job->Task);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// BenchJob - Time reads, interrupt driven and polled (BENCH command)
+//
+// BENCH_COUNT reads are done each way, through the job path the other commands
+//   use, so the times include the task switching a command would see. Polling
+//   is forced on or off only for the moment of each submit, so nothing is left
+//   changed if the job is stopped.
+//
+// Inputs:      Job to run
+//
+// Outputs:     Task state
+//
+static uint8_t BenchJob(JOB *Job) {
+    uint16_t OldPolling;
+
+    TASK_BEGIN(Job->Task);
+
+    for( Job->Mode = 0; Job->Mode < 2; Job->Mode++ ) {
+        Job->NextTime = TimerUS();
+
+        for( Job->Index = 0; Job->Index < BENCH_COUNT; Job->Index++ ) {
+            TASK_WAIT(Job->Task,XferIdle(Job));
+            OldPolling = I2CSetPolling(Job->Mode ? I2C_POLL_ALWAYS : 0);
+            SubmitXfer(Job,Job->SlaveAddr,0,NULL,Job->nBytes,Job->Buffer,0);
+            I2CSetPolling(OldPolling);
+            TASK_WAIT(Job->Task,XferIdle(Job));
+            Job->Status = Job->Xfer.Status;
+
+            if( Job->Status != I2C_COMPLETE )
+                break;
+            }
+
+        Job->Sum = TimerUS() - Job->NextTime;
+
+        TASK_WAIT(Job->Task,OutputRoom() >= MAX_LINE);
+        PrintJobID(Job);
+        PrintString(Job->Mode ? "Polled:    " : "Interrupt: ");
+
+        if( Job->Status != I2C_COMPLETE ) {
+            PrintStatus(Job->Status);
+            TASK_EXIT(Job->Task);
+            }
+
+        PrintD(Job->Sum/BENCH_COUNT,5);
+        PrintString(" us per read\r\n");
+        }
+
+    PrintCRLF();
+
+    TASK_END(Job->Task);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// AutotuneJob - Find the fastest bus speed a slave works at (AUTOTUNE command)
+//
+// A reference read is taken at AUTOTUNE_LOW. Each speed tried is then set as the
+//   slave's profile, and the same registers read AUTOTUNE_READS times: a read
+//   which fails or doesn't match the reference makes that speed bad. Mode is
+//   the step: AUTOTUNE_LOW, then AUTOTUNE_HIGH, then halving the gap between
+//   the fastest good speed (Addr) and the slowest bad one (Left).
+//
+// A read which takes too long means the slave is holding the bus, and another
+//   speed won't tell us anything, so the search stops there. The job doesn't
+//   wait for the read: anything reusing the slot waits for XferIdle() anyway.
+//
+// The result, less the margin, is kept as the slave's profile, and that profile
+//   (only) is saved. Otherwise, or if the job is stopped early, AutotuneStop()
+//   gives the slave back the profile it had before (Sum), and nothing is saved.
+//
+// Inputs:      Job to run
+//
+// Outputs:     Task state (AutotuneJob), speed to try (AutotuneKHz)
+//
+static uint16_t AutotuneKHz(JOB *Job) {
+
+    if( Job->Mode == 0 ) return(AUTOTUNE_LOW);
+    if( Job->Mode == 1 ) return(AUTOTUNE_HIGH);
+    return((Job->Addr+Job->Left)/2);
+    }
+
+static void AutotuneStop(JOB *Job) {
+
+    ConfigSetProfile(Job->SlaveAddr,Job->Sum);
+    Job->Stop = NULL;
+    }
+
+static uint8_t AutotuneJob(JOB *Job) {
+
+    TASK_BEGIN(Job->Task);
+
+    ConfigSetProfile(Job->SlaveAddr,AUTOTUNE_LOW);
+
+    TASK_WAIT(Job->Task,XferIdle(Job));
+    SubmitXfer(Job,Job->SlaveAddr,1,&Job->Reg,Job->nBytes,Job->Buffer,0);
+    TASK_WAIT(Job->Task,XferIdle(Job));
+    Job->Status = Job->Xfer.Status;
+
+    if( Job->Status != I2C_COMPLETE ) {
+        AutotuneStop(Job);
+        TASK_WAIT(Job->Task,OutputRoom() >= MAX_LINE);
+        PrintJobID(Job);
+        PrintString("Reference read: ");
+        PrintStatus(Job->Status);
+        TASK_EXIT(Job->Task);
+        }
+
+    Job->Addr = AUTOTUNE_LOW;               // Fastest good, once tried
+    Job->Left = AUTOTUNE_HIGH;              // Slowest bad, once tried
+
+    for( Job->Mode = 0; Job->Mode < 2 || Job->Left - Job->Addr >= AUTOTUNE_STEP; Job->Mode++ ) {
+
+        ConfigSetProfile(Job->SlaveAddr,AutotuneKHz(Job));
+        memset(Job->Errors,0,sizeof(Job->Errors));
+
+        for( Job->Index = 0; Job->Index < AUTOTUNE_READS; Job->Index++ ) {
+            memset(&Job->Buffer[Job->nBytes],0xFF,Job->nBytes);
+
+            TASK_WAIT(Job->Task,XferIdle(Job));
+            SubmitXfer(Job,Job->SlaveAddr,1,&Job->Reg,Job->nBytes,&Job->Buffer[Job->nBytes],0);
+            Job->NextTime = TimerMS() + AUTOTUNE_TIMEOUT;
+
+            TASK_WAIT(Job->Task,XferIdle(Job) || TimerPast(Job->NextTime));
+            if( !XferIdle(Job) )
+                break;
+
+            if( Job->Xfer.Status != I2C_COMPLETE )
+                Job->Errors[AUTOTUNE_FAILED]++;
+            else if( memcmp(Job->Buffer,&Job->Buffer[Job->nBytes],Job->nBytes) != 0 )
+                Job->Errors[AUTOTUNE_BAD]++;
+            }
+
+        if( Job->Index < AUTOTUNE_READS ) {
+            I2CCancel(&Job->Xfer);          // (In case it never got the bus)
+            AutotuneStop(Job);
+            TASK_WAIT(Job->Task,OutputRoom() >= MAX_LINE);
+            PrintJobID(Job);
+            PrintD(AutotuneKHz(Job),5);
+            PrintString(" KHz: timed out, profile restored\r\n");
+            PrintCRLF();
+            TASK_EXIT(Job->Task);
+            }
+
+        TASK_WAIT(Job->Task,OutputRoom() >= MAX_LINE);
+        PrintJobID(Job);
+        PrintD(AutotuneKHz(Job),5);
+        PrintString(" KHz: ");
+
+        if( Job->Errors[AUTOTUNE_FAILED] == 0 &&
+            Job->Errors[AUTOTUNE_BAD]    == 0 ) {
+            PrintString("OK\r\n");
+            Job->Addr = AutotuneKHz(Job);
+            if( Job->Mode == 1 )
+                break;
+            continue;
+            }
+
+        PrintD(Job->Errors[AUTOTUNE_FAILED],0);
+        PrintString(" failed, ");
+        PrintD(Job->Errors[AUTOTUNE_BAD],0);
+        PrintString(" bad data\r\n");
+
+        if( Job->Mode == 0 ) {
+            AutotuneStop(Job);
+            PrintCRLF();
+            TASK_EXIT(Job->Task);
+            }
+        Job->Left = AutotuneKHz(Job);
+        }
+
+    Job->Addr -= Job->Addr/AUTOTUNE_MARGIN;
+
+    TASK_WAIT(Job->Task,OutputRoom() >= MAX_LINE);
+    Job->Stop = NULL;
+    ConfigSetProfile(Job->SlaveAddr,Job->Addr);
+
+    PrintJobID(Job);
+    PrintString("Profile ");
+    PrintH(Job->SlaveAddr);
+    PrintString(": ");
+    PrintD(Job->Addr,0);
+    if( ConfigSaveProfile(Job->SlaveAddr) )
+        PrintString(" KHz, profile saved\r\n");
+    else
+        PrintString(" KHz, not saved\r\n");
+    PrintCRLF();
+
+    TASK_END(Job->Task);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// SampleJob - Periodically read slave registers (P command)
+//
+// Runs until stopped. If the output falls behind, samples are skipped rather
+//   than bunched up.
+//
+// Inputs:      Job to run
+//
+// Outputs:     Task state
+//
+static uint8_t SampleJob(JOB *Job) {
+    SAMPLE Sample;
+
+    TASK_BEGIN(Job->Task);
+
+    Job->NextTime = TimerMS();
+
+    while(1) {
+        TASK_WAIT(Job->Task,TimerPast(Job->NextTime));
+
+        Job->NextTime += Job->Period;
+        if( TimerPast(Job->NextTime) )
+            Job->NextTime = TimerMS() + Job->Period;
+
+        //
+        // Our buffer can't be reused until the last sample has been printed
+        //
+        TASK_WAIT(Job->Task,ReportDone(Job) && XferIdle(Job));
+        SubmitXfer(Job,Job->SlaveAddr,1,&Job->Reg,Job->nBytes,Job->Buffer,I2C_SPLIT);
+        TASK_WAIT(Job->Task,XferIdle(Job));
+        Job->Status = Job->Xfer.Status;
+
+        //
+        // In log mode the sample goes to the binary log instead. (If the sample
+        //   buffer is full the sample is dropped, same as a trigger edge.)
+        //
+        if( LogActive() ) {
+            Sample.Time      = Job->Xfer.Queued;
+            Sample.Channel   = JobChannel(Job);
+            Sample.SlaveAddr = Job->SlaveAddr;
+            Sample.Status    = Job->Status;
+            Sample.nBytes    = Job->nBytes;
+            memcpy(Sample.Data,Job->Buffer,Job->nBytes);
+            PutSample(&Sample);
+            continue;
+            }
+
+        TASK_WAIT(Job->Task,ReportIdle(Job));
+        PostReport(Job,NULL,Job->Status,REPORT_SAMPLE);
+        }
+
+    TASK_END(Job->Task);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// ConsoleTask - Feed serial input to the command line editor
+//
+// Input is processed while a command runs, but a completed line waits until the
+//   running command finishes. ESC aborts the running command.
+//
+// A streamed W line is taken only as fast as the bus can send it. The gaps between
+//   chars are timed, since only a pasted line is streamed.
+//
+// In log mode the UART belongs to the log, and ESC (which stops it) is the only
+//   input that counts.
+//
+// BP_ENTRY_NULS NULs in a row enter Bus Pirate mode, whose job then reads the
+//   UART itself until it ends.
+//
+// The startup script is fed in as though typed, each command once the last has
+//   finished. While it runs typing is ignored, except for ESC which stops it.
+//
+// Inputs:      None.
+//
+// Outputs:     Task state
+//
+static uint8_t ConsoleTask(void) {
+    static TASK    Task;
+    static char    InChar;
+    static uint8_t NULs;
+
+    TASK_BEGIN(Task);
+    while(1) {
+        TASK_WAIT(Task,(UARTReady() || (ConfigScriptReady() && FgJob.Run == NULL &&
+                                        UARTRoom() >= MAX_LINE)) && !BPActive());
+
+        if( UARTReady() ) {
+            InChar = GetUARTByte();
+            if( ConfigScriptReady() ) {
+                if( InChar != ESC_CMD[0] )
+                    continue;
+                ConfigScriptStop();
+                if( FgJob.Run == NULL ) {
+                    PrintString("\r\nScript stopped\r\n");
+                    GetLineInit();
+                    continue;
+                    }
+                }
+            }
+        else InChar = ConfigScriptGet();
+
+        if( LogActive() ) {
+            if( InChar == ESC_CMD[0] ) {
+                LogStop();
+                PrintString("\r\nLog stopped\r\n");
+                Prompt();
+                }
+            continue;
+            }
+
+        if( InChar == ESC_CMD[0] && FgJob.Run != NULL ) {
+            AbortJob(&FgJob);
+            PrintString("Aborted\r\n");
+            GetLineInit();                  // Drop any unfinished (streamed) line
+            continue;
+            }
+
+        if( InChar == 0 ) {
+            if( ++NULs < BP_ENTRY_NULS )
+                continue;
+            NULs = 0;
+            TASK_WAIT(Task,FgJob.Run == NULL);
+            BPStart();
+            continue;
+            }
+        NULs = 0;
+
+        if( FgJob.Run == StreamJob )
+            TASK_WAIT(Task,FgJob.Size - FgJob.nBytes >= STREAM_ROOM || FgJob.Run != StreamJob);
+
+        if( InChar == '\r' )
+            TASK_WAIT(Task,(FgJob.Run == NULL && XferIdle(&FgJob)) || FgJob.Run == StreamJob);
+
+        if( !MidLine )
+            Overrun = false;
+        if( MidLine && TimerMS() - InputTime > STREAM_GAP )
+            Typed = true;
+        if( UARTOverrun() )
+            Overrun = true;
+        InputTime = TimerMS();
+        MidLine   = (InChar != '\r');
+        if( !MidLine )
+            Typed = false;
+
+        ProcessSerialInput(InChar);
+        }
+    TASK_END(Task);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// ParseSlaveAddr - Parse the slave address token
+// ParseKHz       - Parse a bus speed token into Word
+// ParseReg       - Parse the register token
+//
+// Inputs:      None (examines next token on line)
+//              TRUE if 0 is allowed (ParseKHz only)
+//
+// Outputs:     TRUE  if value parsed correctly
+//              FALSE if error (error message has been printed)
+//
+static bool ParseSlaveAddr(void) {
+
+    if( !ParseValue() ) {
+        PrintString("Unrecognized slave addr (");
+        PrintString(Token);
+        PrintString("), must 2 hex chars.\r\n");
+        PrintString("Type '?' for help\r\n");
+        PrintCRLF();
+        return(false);
+        }
+
+    SlaveAddr = Value;
+    return(true);
+    }
+
+static bool ParseKHz(bool ZeroOK) {
+
+    if( ParseWord() == 0 || Word > 1000 || (Word == 0 && !ZeroOK) ) {
+        PrintString("Unrecognized speed (");
+        PrintString(Token);
+        PrintString(ZeroOK ? "), must 0 to #1000 KHz.\r\n" : "), must #1 to #1000 KHz.\r\n");
+        PrintString("Type '?' for help\r\n");
+        PrintCRLF();
+        return(false);
+        }
+
+    return(true);
+    }
+
+static bool ParseReg(void) {
+
+    if( !ParseValue() ) {
+        PrintString("Unrecognized reg (");
+        PrintString(Token);
+        PrintString("), must 2 hex chars.\r\n");
+        PrintString("Type '?' for help\r\n");
+        PrintCRLF();
+        return(false);
+        }
+
+    Reg = Value;
+    return(true);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// PrintQueueStats - Print bus queueing stats for each priority (Q command)
+//
+// Delays are from queueing a transfer until it goes out on the bus. Splits are
+//   the number of background reads broken up to let a foreground transfer in,
+//   and Polled the number short enough to run without interrupts.
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+static void PrintQueueStats(void) {
+    I2C_QSTATS Stats;
+
+    PrintString("Queue  Count  MaxWait  AvgWait  Splits  Polled  (us)\r\n");
+
+    for( uint8_t Pri = 0; Pri < I2C_NUM_PRI; Pri++ ) {
+        I2CGetStats(Pri,&Stats,true);
+        PrintString(Pri == I2C_PRI_HIGH ? "High " : "Low  ");
+        PrintD(Stats.Count,6);
+        PrintD(Stats.MaxWait,9);
+        PrintD(Stats.Count ? Stats.TotalWait/Stats.Count : 0,9);
+        PrintD(Stats.Splits,8);
+        PrintD(Stats.Polled,8);
+        PrintCRLF();
+        }
+    PrintCRLF();
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// PrintBusLoad - Print bus use and clock stretching since last time (BUSLOAD command)
+//
+// Busy us over elapsed ms gives tenths of a percent directly. Slaves are listed
+//   worst stretch first. Stats which filled up cover the time until they did.
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+static void PrintBusLoad(void) {
+    I2C_BUSSTATS Stats;
+    I2C_STRETCH *Slave;
+    I2C_STRETCH *Worst;
+    uint32_t     Elapsed;
+    uint32_t     Permille;
+
+    I2CGetBusStats(&Stats,true);
+
+    Elapsed  = (Stats.Full ? Stats.Until : TimerMS()) - Stats.Since;
+    Permille = Elapsed ? Stats.Busy/Elapsed : 0;
+    if( Permille > 1000 )
+        Permille = 1000;
+
+    PrintString("Busy:   ");
+    PrintD(Permille/10,4);
+    PrintChar('.');
+    PrintD(Permille%10,0);
+    PrintString("% of ");
+    PrintD(Elapsed/1000,0);
+    PrintChar('.');
+    PrintD((Elapsed/100)%10,0);
+    PrintString(" s\r\n");
+
+    if( Stats.Full )
+        PrintString("        (stats full, nothing counted after that)\r\n");
+
+    PrintString("Xfers:  ");
+    PrintD(Stats.Xfers,5);
+    PrintString(", avg ");
+    PrintD(Stats.Xfers ? Stats.TotalTime/Stats.Xfers : 0,0);
+    PrintString(" us, max ");
+    PrintD(Stats.MaxTime,0);
+    PrintString(" us\r\n");
+    PrintCRLF();
+
+    PrintString("Slave  Xfers  AvgStretch  MaxStretch  (us)\r\n");
+
+    while(1) {
+        Worst = NULL;
+        for( Slave = Stats.Slaves; Slave < &Stats.Slaves[I2C_STRETCH_SLAVES]; Slave++ ) {
+            if( Slave->Addr != 0 && (Worst == NULL || Slave->MaxStretch > Worst->MaxStretch) )
+                Worst = Slave;
+            }
+
+        if( Worst == NULL )
+            break;
+
+        PrintH(Worst->Addr);
+        PrintD(Worst->Count,9);
+        PrintD(Worst->Stretch/Worst->Count,12);
+        PrintD(Worst->MaxStretch,12);
+        PrintCRLF();
+        Worst->Addr = 0;
+        }
+    PrintCRLF();
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// PrintHistLimit - Print a bucket limit, right justified in 6 chars
+// PrintHist      - Print one latency histogram as a row, then its p99
+//
+// The p99 is the limit of the bucket holding the 99th percentile.
+//
+// Inputs:      Bucket (PrintHistLimit), or histogram to print (PrintHist)
+//
+// Outputs:     None.
+//
+static void PrintHistLimit(uint8_t Bucket) {
+    uint8_t Pad = 6 - strlen_P(HistLimits[Bucket]);
+
+    while( Pad-- )
+        PrintChar(' ');
+    PrintStringP(HistLimits[Bucket]);
+    }
+
+static void PrintHist(I2C_HIST *Hist) {
+    uint32_t Total = 0;
+    uint32_t Sum   = 0;
+    uint8_t  Bucket;
+
+    for( Bucket = 0; Bucket < I2C_HIST_BUCKETS; Bucket++ ) {
+        PrintD(Hist->Count[Bucket],6);
+        Total += Hist->Count[Bucket];
+        }
+
+    if( Total ) {
+        for( Bucket = 0; (Sum += Hist->Count[Bucket])*100 < Total*99; Bucket++ )
+            ;
+        PrintHistLimit(Bucket);
+        }
+    PrintCRLF();
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// PrintLatency - Print latency histograms since last time (LATENCY command)
+//
+// One row per transfer type, then one per busy slave: the number of transfers
+//   in each bucket, in us from submit to done, and the p99.
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+static void PrintLatency(void) {
+    I2C_LATENCY Latency;
+    uint8_t     i;
+
+    I2CGetLatency(&Latency,true);
+
+    PrintString("us   ");
+    for( i = 0; i < I2C_HIST_BUCKETS; i++ )
+        PrintHistLimit(i);
+    PrintString("   p99\r\n");
+
+    PrintString("Read "); PrintHist(&Latency.Types[I2C_LAT_READ]);
+    PrintString("Write"); PrintHist(&Latency.Types[I2C_LAT_WRITE]);
+    PrintString("Comb "); PrintHist(&Latency.Types[I2C_LAT_COMBINED]);
+
+    for( i = 0; i < I2C_HIST_SLAVES; i++ ) {
+        if( Latency.Addr[i] == 0 )
+            continue;
+        PrintH(Latency.Addr[i]);
+        PrintString("   ");
+        PrintHist(&Latency.Slaves[i]);
+        }
+    PrintCRLF();
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// PrintMem - Print RAM usage (MEM command)
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+static void PrintMem(void) {
+    MEM_STATS  Stats;
+    POOL_STATS Pool;
+
+    FreeJobBuffers();
+    MemGetStats(&Stats);
+    PoolGetStats(&Pool);
+
+    PrintString("RAM:     ");
+    PrintD(Stats.Size,5);
+    PrintCRLF();
+    PrintString("Static:  ");
+    PrintD(Stats.Static,5);
+    PrintString("  (.data, .bss, .noinit)\r\n");
+    PrintString("Stack:   ");
+    PrintD(Stats.StackMax,5);
+    PrintString("  deepest since reset (");
+    PrintD(Stats.StackNow,0);
+    PrintString(" now)\r\n");
+    PrintString("Free:    ");
+    PrintD(Stats.Free,5);
+    PrintString("  never used\r\n");
+    PrintString("Pool:    ");
+    PrintD(POOL_SIZE,5);
+    PrintString("  ");
+    PrintD(Pool.InUse,0);
+    PrintString(" of ");
+    PrintD(POOL_BLOCKS,0);
+    PrintString(" blocks in use, peak ");
+    PrintD(Pool.Peak,0);
+    PrintString(", ");
+    PrintD(Pool.Allocs,0);
+    PrintString(" allocs, ");
+    PrintD(Pool.Fails,0);
+    PrintString(" failed\r\n");
+    PrintCRLF();
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// PrintConfig - Print the configuration settings (CONFIG command)
+//
+// Speeds and the baud rate are decimal.
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+static void PrintConfig(void) {
+    CONFIG_PROFILE *Profile;
+    char            Char;
+
+    PrintString("Speed:   ");
+    PrintD(Config.KHz,0);
+    PrintString(" KHz\r\n");
+
+    PrintString("Pullups: ");
+    PrintString(Config.Pullups ? "ON\r\n" : "OFF\r\n");
+
+    PrintString("Addr:    ");
+    PrintH(Config.OurAddr);
+    PrintCRLF();
+
+    PrintString("Baud:    ");
+    if( Config.Baud >= 1000 ) {
+        PrintD(Config.Baud/1000,0);
+        PrintD(Config.Baud%1000,103);
+        }
+    else PrintD(Config.Baud,0);
+    PrintCRLF();
+
+    PrintString("Boot:    ");
+    PrintString(Config.FastBoot ? "FAST" : "NORMAL");
+    PrintString(" (last ready 0x");
+    PrintH2(BootCycles >> 16);
+    PrintH2(BootCycles);
+    PrintString(" cycles after reset)\r\n");
+
+    for( Profile = Config.Profiles; Profile < &Config.Profiles[I2C_PROFILES]; Profile++ ) {
+        if( Profile->Addr == 0 )
+            continue;
+        PrintString("Profile: ");
+        PrintH(Profile->Addr);
+        PrintString(" at ");
+        PrintD(Profile->KHz,0);
+        PrintString(" KHz\r\n");
+        }
+
+    PrintString("Script:  ");
+    for( uint16_t Index = 0; (Char = ConfigScript(Index)) != 0; Index++ )
+        PrintChar(Char);
+    PrintCRLF();
+    PrintCRLF();
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// PrintJobStarted - Tell the user the ID of a new background job
+// RunCommand      - Start a command's job
+//
+// Inputs:      Job to start
+//              Job body (RunCommand only)
+//
+// Outputs:     TRUE  if command is finished (background job)
+//              FALSE if command continues as foreground job
+//
+static void PrintJobStarted(JOB *Job) {
+
+    PrintChar('[');
+    PrintD(Job-Jobs,0);
+    PrintString("]\r\n");
+    }
+
+static bool RunCommand(JOB *Job, JOB_FN Run) {
+
+    StartJob(Job,Run);
+
+    if( Job == &FgJob )
+        return(false);
+
+    PrintJobStarted(Job);
+    return(true);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// StreamData - Parse data tokens from the line into a streaming job's buffer
+//
+// The bytes still waiting are first moved to the front of the buffer.
+//
+// Inputs:      Streaming job
+//
+// Outputs:     TRUE  if all tokens were data
+//              FALSE if error (offending token is in Token, nothing printed)
+//
+static bool StreamData(JOB *Job) {
+    uint8_t Count;
+
+    memmove(Job->Buffer,&Job->Buffer[Job->Index],Job->nBytes);
+    Job->Index = 0;
+
+    while( (Count = ParseBytes(&Job->Buffer[Job->nBytes],Job->Size-Job->nBytes)) != 0 ) {
+        if( Count > Job->Size-Job->nBytes )
+            return(false);
+        Job->nBytes += Count;
+        }
+
+    return(Token[0] == 0);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// SerialPartial - Take the completed tokens of a line still being typed
+//
+// A pasted foreground W line with at least STREAM_MIN data bytes starts StreamJob,
+//   and from then on its data goes to the job as it arrives. Anything else waits
+//   for EOL as usual, so a typed line is checked whole and can be edited. After bad
+//   data, or lost input, the rest of a streamed line is discarded (what was sent
+//   stays written).
+//
+// A '&' token is left on the line for SerialCommand(), since it may be the end.
+//
+// Inputs:      Line so far
+//
+// Outputs:     TRUE  if the line was used
+//              FALSE if line should be kept for SerialCommand()
+//
+bool SerialPartial(char *Line) {
+    JOB *Job = &FgJob;
+
+    ParseInit(Line);
+
+    if( Job->Run != StreamJob ) {
+        if( Job->Run != NULL || !XferIdle(Job) || Typed || Overrun ||
+            !StrEQ(ParseToken(),"W")          ||
+            !ParseValue() )
+            return(false);
+
+        if( (Job = NewJob(Line,false)) == NULL )
+            return(false);
+
+        Job->SlaveAddr = Value;
+        Job->Index     = 0;
+        Job->nBytes    = 0;
+        Job->Mode      = 0;
+
+        if( !StreamData(Job) || Job->nBytes < STREAM_MIN )
+            return(false);
+
+        StartJob(Job,StreamJob);
+        return(true);
+        }
+
+    if( StrEQ(ParseToken(),"&") && ParseToken()[0] == 0 )
+        return(false);
+    ParseInit(Line);
+
+    if( (Job->Mode & STREAM_BAD) == 0 && Overrun ) {
+        PrintCRLF();
+        PrintString("Input lost (slave slower than paste), rest of line ignored.\r\n");
+        Job->Mode |= STREAM_BAD;
+        }
+
+    if( (Job->Mode & STREAM_BAD) == 0 && !StreamData(Job) ) {
+        PrintCRLF();
+        PrintString("Unrecognized data (");
+        PrintString(Token);
+        PrintString("), must 0 to FF, or packed hex.\r\n");
+        Job->Mode |= STREAM_BAD;
+        }
+
+    return(true);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// SerialCommand - Manage command lines for this program
+//
+// Bus commands are started as the foreground job and run from CommandTask(). A
+//   trailing '&' starts the command as a background job instead, which runs from
+//   JobsTask() while the user carries on typing.
+//
+// Inputs:      Command line typed by user
+//
+// Outputs:     TRUE  if command is finished
+//              FALSE if command continues as a job
+//
+bool SerialCommand(char *Line) {
+    char    *Command;
+    char    *LineEnd;
+    bool     Background = false;
+    JOB     *Job;
+
+    //
+    // Trailing '&' means run in the background
+    //
+    LineEnd = Line + strlen(Line);
+    while( LineEnd > Line && isspace(LineEnd[-1]) )
+        LineEnd--;
+
+    if( LineEnd > Line && LineEnd[-1] == '&' ) {
+        do LineEnd--;
+        while( LineEnd > Line && isspace(LineEnd[-1]) );
+        *LineEnd   = 0;
+        Background = true;
+        }
+
+    //
+    // End of a streamed W line
+    //
+    if( FgJob.Run == StreamJob ) {
+        SerialPartial(Line);
+        FgJob.Mode |= STREAM_END;
+        if( Background )
+            PrintString("Streamed W ran in the foreground, '&' ignored\r\n");
+        return(false);
+        }
+
+    ParseInit(Line);
+    Command = ParseToken();
+
+    //
+    // P - Poll registers in the background, or stop polling
+    //
+    // Polling always runs in the background, '&' or not.
+    //
+    if( StrEQ(Command,"P") ) {
+
+        if( ParseToken()[0] == 0 ) {
+            for( Job = &Jobs[1]; Job < &Jobs[MAX_JOBS]; Job++ ) {
+                if( Job->Run == SampleJob )
+                    AbortJob(Job);
+                }
+            PrintString("Polling stopped\r\n");
+            PrintCRLF();
+            return(true);
+            }
+
+        ParseInit(Line);                // Back up over the token we peeked at
+        ParseToken();
+
+        if( (Job = NewJob(Line,true)) == NULL )
+            return(true);
+
+        if( !ParseSlaveAddr() ||
+            !ParseReg()       ||
+            !ParseNBytes(MAX_POLLBYTES) )
+            return(true);
+
+        if( !ParseValue() || Value == 0 ) {
+            PrintString("Unrecognized period (");
+            PrintString(Token);
+            PrintString("), must 1 to FF ms.\r\n");
+            PrintString("Type '?' for help\r\n");
+            PrintCRLF();
+            return(true);
+            }
+
+        Job->SlaveAddr = SlaveAddr;
+        Job->Reg       = Reg;
+        Job->nBytes    = nBytes;
+        Job->Period    = Value;
+        StartJob(Job,SampleJob);
+        PrintJobStarted(Job);
+        return(true);
+        }
+
+
+    //
+    // Job control
+    //
+    if( StrEQ(Command,"JOBS") ) {
+        ListJobs();
+        return(true);
+        }
+
+    if( StrEQ(Command,"KILL") ) {
+        if( !ParseValue() || !KillJob(Value) ) {
+            PrintString("No such job (");
+            PrintString(Token);
+            PrintString(").\r\n");
+            PrintString("Type 'jobs' for a list\r\n");
+            PrintCRLF();
+            return(true);
+            }
+        PrintChar('[');
+        PrintD(Value,0);
+        PrintString("] Killed\r\n");
+        PrintCRLF();
+        return(true);
+        }
+
+
+    //
+    // T - Pin triggers
+    //
+    if( StrEQ(Command,"T") ) {
+        TRIG_MODE Mode;
+        uint8_t   Trigger;
+
+        if( !ParseValue() ) {
+            if( Token[0] == 0 ) {
+                ListTriggers();
+                return(true);
+                }
+            Value = NUM_TRIGGERS;
+            }
+
+        if( Value >= NUM_TRIGGERS ) {
+            PrintString("Unrecognized trigger (");
+            PrintString(Token);
+            PrintString("), must 0 to ");
+            PrintD(NUM_TRIGGERS-1,0);
+            PrintString(".\r\n");
+            PrintString("Type '?' for help\r\n");
+            PrintCRLF();
+            return(true);
+            }
+        Trigger = Value;
+
+        Token = ParseToken();
+        if     ( StrEQ(Token,"OFF") ) Mode = TRIG_OFF;
+        else if( StrEQ(Token,"R"  ) ) Mode = TRIG_RISING;
+        else if( StrEQ(Token,"F"  ) ) Mode = TRIG_FALLING;
+        else if( StrEQ(Token,"B"  ) ) Mode = TRIG_BOTH;
+        else if( StrEQ(Token,"A"  ) ) Mode = TRIG_ALERT;
+        else {
+            PrintString("Unrecognized trigger mode (");
+            PrintString(Token);
+            PrintString("), must R, F, B, A, or OFF.\r\n");
+            PrintString("Type '?' for help\r\n");
+            PrintCRLF();
+            return(true);
+            }
+
+        SlaveAddr = 0;
+        Reg       = 0;
+        nBytes    = 0;
+
+        if( Mode == TRIG_ALERT ) {
+            if( !ParseValue() ) {
+                if( Token[0] != 0 ) {
+                    PrintString("Unrecognized reg (");
+                    PrintString(Token);
+                    PrintString("), must 2 hex chars.\r\n");
+                    PrintString("Type '?' for help\r\n");
+                    PrintCRLF();
+                    return(true);
+                    }
+                }
+            else {
+                Reg = Value;
+                if( !ParseNBytes(MAX_TRIGBYTES) )
+                    return(true);
+                }
+            }
+        else if( Mode != TRIG_OFF ) {
+            if( !ParseSlaveAddr() ||
+                !ParseReg()       ||
+                !ParseNBytes(MAX_TRIGBYTES) )
+                return(true);
+            }
+
+        SetTrigger(Trigger,Mode,SlaveAddr,Reg,nBytes);
+        ListTriggers();
+        return(true);
+        }
+
+
+    //
+    // Q - Bus queueing stats
+    //
+    if( StrEQ(Command,"Q") ) {
+        PrintQueueStats();
+        return(true);
+        }
+
+
+    //
+    // BUSLOAD - Bus use and clock stretching
+    //
+    if( StrEQ(Command,"BUSLOAD") ) {
+        PrintBusLoad();
+        return(true);
+        }
+
+
+    //
+    // LATENCY - Latency histograms
+    //
+    if( StrEQ(Command,"LATENCY") ) {
+        PrintLatency();
+        return(true);
+        }
+
+
+    //
+    // MEM - RAM usage
+    //
+    if( StrEQ(Command,"MEM") ) {
+        PrintMem();
+        return(true);
+        }
+
+
+    //
+    // CONFIG - Show or change the settings kept in EEPROM
+    //
+    if( StrEQ(Command,"CONFIG") ) {
+
+        Token = ParseToken();
+
+        if( Token[0] == 0 ) {
+            PrintConfig();
+            return(true);
+            }
+
+        if( StrEQ(Token,"SAVE") ) {
+            ConfigSave();
+            PrintString("Config saved\r\n");
+            PrintCRLF();
+            return(true);
+            }
+
+        if( StrEQ(Token,"ERASE") ) {
+            ConfigErase();
+            PrintString("Config erased, defaults from next reset\r\n");
+            PrintCRLF();
+            return(true);
+            }
+
+        if( StrEQ(Token,"SPEED") ) {
+            if( !ParseKHz(false) )
+                return(true);
+            Config.KHz = Word;
+            I2CSetSpeed(Word);
+            }
+        else if( StrEQ(Token,"PULLUPS") ) {
+            Token = ParseToken();
+            if     ( StrEQ(Token,"ON" ) ) Config.Pullups = true;
+            else if( StrEQ(Token,"OFF") ) Config.Pullups = false;
+            else {
+                PrintString("Unrecognized pullups (");
+                PrintString(Token);
+                PrintString("), must ON or OFF.\r\n");
+                PrintString("Type '?' for help\r\n");
+                PrintCRLF();
+                return(true);
+                }
+            I2CSetPullups(Config.Pullups);
+            }
+        else if( StrEQ(Token,"BOOT") ) {
+            Token = ParseToken();
+            if     ( StrEQ(Token,"FAST"  ) ) Config.FastBoot = true;
+            else if( StrEQ(Token,"NORMAL") ) Config.FastBoot = false;
+            else {
+                PrintString("Unrecognized boot (");
+                PrintString(Token);
+                PrintString("), must FAST or NORMAL.\r\n");
+                PrintString("Type '?' for help\r\n");
+                PrintCRLF();
+                return(true);
+                }
+            }
+        else if( StrEQ(Token,"ADDR") ) {
+            if( !ParseValue() || Value > 0x7F ) {
+                PrintString("Unrecognized addr (");
+                PrintString(Token);
+                PrintString("), must 0 to 7F.\r\n");
+                PrintString("Type '?' for help\r\n");
+                PrintCRLF();
+                return(true);
+                }
+            Config.OurAddr = Value;
+            }
+        else if( StrEQ(Token,"BAUD") ) {
+            if( ParseNumber() == 0 || Number < 300 || Number > 1000000 ) {
+                PrintString("Unrecognized baud (");
+                PrintString(Token);
+                PrintString("), must #300 to #1000000.\r\n");
+                PrintString("Type '?' for help\r\n");
+                PrintCRLF();
+                return(true);
+                }
+            Config.Baud = Number;
+            }
+        else if( StrEQ(Token,"PROFILE") ) {
+            if( !ParseSlaveAddr() ||
+                !ParseKHz(true) )
+                return(true);
+
+            if( !ConfigSetProfile(SlaveAddr,Word) ) {
+                PrintString("No free profile, must <= ");
+                PrintD(I2C_PROFILES,0);
+                PrintString(" slaves.\r\n");
+                PrintCRLF();
+                return(true);
+                }
+            }
+        else if( StrEQ(Token,"SCRIPT") ) {
+            if( !ConfigSetScript(ParseRest()) ) {
+                PrintString("Script too long, must < ");
+                PrintD(CONFIG_SCRIPT_SIZE,0);
+                PrintString(" chars.\r\n");
+                PrintCRLF();
+                return(true);
+                }
+            }
+        else {
+            PrintString("Unrecognized config (");
+            PrintString(Token);
+            PrintString("), must SPEED, PULLUPS, BOOT, ADDR, BAUD,\r\n");
+            PrintString("  PROFILE, SCRIPT, SAVE or ERASE.\r\n");
+            PrintString("Type '?' for help\r\n");
+            PrintCRLF();
+            return(true);
+            }
+
+        PrintConfig();
+        return(true);
+        }
+
+
+    //
+    // LOG - Binary sample log. No prompt until ESC ends it.
+    //
+    if( StrEQ(Command,"LOG") ) {
+        PrintString("Logging, ESC to stop\r\n");
+        LogStart();
+        return(false);
+        }
+
+
+    //
+    // Bus commands. Everything after this point runs as a job.
+    //
+    if( StrEQ(Command,"R") ||
+        StrEQ(Command,"W") ||
+        StrEQ(Command,"V") ||
+        StrEQ(Command,"S") ||
+        StrEQ(Command,"D") ||
+        StrEQ(Command,"G") ||
+        StrEQ(Command,"CHECKSUM") ||
+        StrEQ(Command,"EXPECT") ||
+        StrEQ(Command,"XFER") ||
+        StrEQ(Command,"INIT") ||
+        StrEQ(Command,"BENCH") ||
+        StrEQ(Command,"AUTOTUNE") ) {
+
+        if( (Job = NewJob(Line,Background)) == NULL )
+            return(true);
+        }
+    else Job = NULL;
+
+
+    //
+    // R - Read bytes from slave
+    //
+    if( StrEQ(Command,"R") ) {
+        if( !ParseSlaveAddr() ||
+            !ParseNBytes(Job->Size) )
+            return(true);
+
+        Job->SlaveAddr = SlaveAddr;
+        Job->nBytes    = nBytes;
+        return(RunCommand(Job,ReadJob));
+        }
+
+
+    //
+    // W - Write bytes to slave
+    // V - Write bytes to slave, read back and compare (first byte is register)
+    //
+    if( StrEQ(Command,"W") ||
+        StrEQ(Command,"V") ) {
+        uint8_t Count;
+
+        Job->Mode = StrEQ(Command,"V") ? I2C_VERIFY : 0;  // (Parsing overwrites Command)
+
+        if( !ParseSlaveAddr() )
+            return(true);
+
+        for( nBytes = 0; (Count = ParseBytes(&Job->Buffer[nBytes],Job->Size-nBytes)) != 0; nBytes += Count ) {
+            if( Count > Job->Size-nBytes ) {
+                PrintString("Too much data (");
+                PrintString(Token);
+                PrintString("), must <= ");
+                PrintH(Job->Size);
+                PrintString(".\r\n");
+                PrintString("Type '?' for help\r\n");
+                PrintCRLF();
+                return(true);
+                }
+            }
+
+        if( Token[0] != 0 ) {
+            PrintString("Unrecognized data (");
+            PrintString(Token);
+            PrintString("), must 0 to FF, or packed hex.\r\n");
+            PrintString("Type '?' for help\r\n");
+            PrintCRLF();
+            return(true);
+            }
+
+        if( Job->Mode == I2C_VERIFY && nBytes < 2 ) {
+            PrintString("Nothing to verify, need <reg> and data.\r\n");
+            PrintString("Type '?' for help\r\n");
+            PrintCRLF();
+            return(true);
+            }
+
+        Job->SlaveAddr = SlaveAddr;
+        Job->nBytes    = nBytes;
+        return(RunCommand(Job,WriteJob));
+        }
+
+
+    //
+    // S - Scan for slaves by reading register (default: Reg 0)
+    //
+    if( StrEQ(Command,"S") )
+        return(RunCommand(Job,ScanJob));
+
+
+    //
+    // D - Dump specified registers from device
+    // G - Get all registers using repeated start
+    //
+    if( StrEQ(Command,"D") ||
+        StrEQ(Command,"G") ) {
+        Job->RepStart = StrEQ(Command,"G");     // (Parsing overwrites Command)
+
+        if( !ParseSlaveAddr() ||
+            !ParseReg()       ||
+            !ParseNBytes(Job->Size) )
+            return(true);
+
+        Job->SlaveAddr = SlaveAddr;
+        Job->Reg       = Reg;
+        Job->nBytes    = nBytes;
+        return(RunCommand(Job,DumpJob));
+        }
+
+
+    //
+    // CHECKSUM - Checksum slave memory. An address of more than 2 hex chars is
+    //   sent as 2 bytes, for EEPROMs and the like.
+    //
+    if( StrEQ(Command,"CHECKSUM") ) {
+        if( !ParseSlaveAddr() )
+            return(true);
+
+        if( (Job->AddrBytes = ParseWord()) == 0 ) {
+            PrintString("Unrecognized addr (");
+            PrintString(Token);
+            PrintString("), must 1 to 4 hex chars.\r\n");
+            PrintString("Type '?' for help\r\n");
+            PrintCRLF();
+            return(true);
+            }
+        Job->Addr = Word;
+
+        if( ParseWord() == 0 || Word == 0 ) {
+            PrintString("Unrecognized length (");
+            PrintString(Token);
+            PrintString("), must 1 to FFFF.\r\n");
+            PrintString("Type '?' for help\r\n");
+            PrintCRLF();
+            return(true);
+            }
+        Job->Left = Word;
+
+        Token = ParseToken();
+        if     ( Token[0] == 0 || StrEQ(Token,"CRC32") ) Job->Mode = CHECK_CRC32;
+        else if( StrEQ(Token,"CRC16")    )               Job->Mode = CHECK_CRC16;
+        else if( StrEQ(Token,"FLETCHER") )               Job->Mode = CHECK_FLETCHER;
+        else {
+            PrintString("Unrecognized checksum (");
+            PrintString(Token);
+            PrintString("), must CRC32, CRC16, or FLETCHER.\r\n");
+            PrintString("Type '?' for help\r\n");
+            PrintCRLF();
+            return(true);
+            }
+
+        Job->SlaveAddr = SlaveAddr;
+        Job->Status    = I2C_COMPLETE;
+        return(RunCommand(Job,ChecksumJob));
+        }
+
+
+    //
+    // EXPECT - Compare slave registers against expected values, with an
+    //   optional mask for each. Missing masks are FF (compare all bits).
+    //
+    if( StrEQ(Command,"EXPECT") ) {
+        uint8_t *Expect;
+        uint8_t *Mask;
+        uint8_t  Max = Job->Size/3;
+        uint8_t  i;
+
+        if( !ParseSlaveAddr() ||
+            !ParseReg() )
+            return(true);
+
+        //
+        // Values are parsed to the end of the buffer, then moved into place
+        //   once the count is known.
+        //
+        Expect = &Job->Buffer[Job->Size-2*Max];
+        Mask   = &Job->Buffer[Job->Size-Max];
+
+        for( nBytes = 0; (i = ParseBytes(&Expect[nBytes],Max-nBytes)) != 0; nBytes += i ) {
+            if( i > Max-nBytes )
+                break;
+            }
+
+        if( nBytes == 0 || i != 0 || (Token[0] != 0 && !StrEQ(Token,"MASK")) ) {
+            PrintString("Unrecognized value (");
+            PrintString(Token);
+            PrintString("), must 1 to ");
+            PrintH(Max);
+            PrintString(" bytes, then MASK.\r\n");
+            PrintString("Type '?' for help\r\n");
+            PrintCRLF();
+            return(true);
+            }
+
+        memset(Mask,0xFF,Max);
+        if( StrEQ(Token,"MASK") ) {
+            uint8_t nMasks;
+
+            for( nMasks = 0; (i = ParseBytes(&Mask[nMasks],nBytes-nMasks)) != 0; nMasks += i ) {
+                if( i > nBytes-nMasks )
+                    break;
+                }
+            }
+
+        if( i != 0 || Token[0] != 0 ) {
+            PrintString("Unrecognized mask (");
+            PrintString(Token);
+            PrintString("), must <= 1 per value.\r\n");
+            PrintString("Type '?' for help\r\n");
+            PrintCRLF();
+            return(true);
+            }
+
+        memmove(&Job->Buffer[nBytes],Expect,nBytes);
+        memmove(&Job->Buffer[2*nBytes],Mask,nBytes);
+
+        Job->SlaveAddr = SlaveAddr;
+        Job->Reg       = Reg;
+        Job->nBytes    = nBytes;
+        return(RunCommand(Job,ExpectJob));
+        }
+
+
+    //
+    // XFER - Combined transfer, as the Linux i2ctransfer command
+    //
+    // Each message becomes one transfer of a chain. Message data goes at the
+    //   front of the job buffer, and the transfers after the first at the back.
+    //
+    if( StrEQ(Command,"XFER") ) {
+        I2C_XFER *Xfer  = NULL;         // Last message so far
+        I2C_XFER *Link;
+        uint8_t   Used  = 0;            // Buffer bytes used by data
+        uint8_t   Links = 0;            // Transfers at back of buffer
+        uint8_t   Left  = 0;            // Write data still to come
+        uint8_t   Count;
+        char      Dir;
+
+        SlaveAddr = 0xFF;
+
+        while(1) {
+            if( (Count = ParseBytes(&Job->Buffer[Used-Left],Left)) != 0 ) {
+                if( Count > Left ) {
+                    PrintString("Unexpected data (");
+                    PrintString(Token);
+                    PrintString("), more than w<nBytes>.\r\n");
+                    PrintString("Type '?' for help\r\n");
+                    PrintCRLF();
+                    return(true);
+                    }
+                Left -= Count;
+                continue;
+                }
+
+            if( Token[0] == 0 || Left != 0 )
+                break;
+
+            if( (Dir = ParseMessage()) == 0 )
+                return(true);
+
+            if( SlaveAddr == 0xFF ) {
+                PrintString("No slave address, first message must have @<slave>.\r\n");
+                PrintString("Type '?' for help\r\n");
+                PrintCRLF();
+                return(true);
+                }
+
+            if( Dir == 'r' && nBytes == 0 ) {
+                PrintString("nBytes cannot be zero! Causes hang!\r\n");
+                PrintString("Type '?' for help\r\n");
+                PrintCRLF();
+                return(true);
+                }
+
+            if( Xfer != NULL )
+                Links++;
+
+            if( Used + nBytes + Links*sizeof(I2C_XFER) > Job->Size ) {
+                PrintString("Too much data (");
+                PrintString(Token);
+                PrintString("), buffer full.\r\n");
+                PrintString("Type '?' for help\r\n");
+                PrintCRLF();
+                return(true);
+                }
+
+            Link = Xfer == NULL ? &Job->Xfer : (I2C_XFER *) &Job->Buffer[Job->Size] - Links;
+            Link->SlaveAddr = SlaveAddr;
+            Link->WrBytes   = Dir == 'w' ? nBytes : 0;
+            Link->WrBuffer  = &Job->Buffer[Used];
+            Link->RdBytes   = Dir == 'r' ? nBytes : 0;
+            Link->RdBuffer  = &Job->Buffer[Used];
+            Link->Flags     = 0;
+            Link->Chain     = NULL;
+            Link->Segs      = NULL;
+            if( Xfer != NULL )
+                Xfer->Chain = Link;
+            Xfer = Link;
+
+            Used += nBytes;
+            Left  = Link->WrBytes;
+            }
+
+        if( Left != 0 ) {
+            PrintString("Not enough data (");
+            PrintString(Token);
+            PrintString("), need ");
+            PrintD(Left,0);
+            PrintString(" more bytes to write.\r\n");
+            PrintString("Type '?' for help\r\n");
+            PrintCRLF();
+            return(true);
+            }
+
+        if( Xfer == NULL ) {
+            PrintString("Nothing to transfer, need r<nBytes>@<slave> or w<nBytes>@<slave>.\r\n");
+            PrintString("Type '?' for help\r\n");
+            PrintCRLF();
+            return(true);
+            }
+
+        return(RunCommand(Job,XferJob));
+        }
+
+
+    //
+    // INIT - Run a device init script from flash, or list them
+    //
+    if( StrEQ(Command,"INIT") ) {
+        PGM_P Name;
+
+        Token = ParseToken();
+
+        if( Token[0] == 0 ) {
+            for( nBytes = 0; (Name = InitName(nBytes)) != NULL; nBytes++ ) {
+                PrintStringP(Name);
+                PrintCRLF();
+                }
+            PrintCRLF();
+            return(true);
+            }
+
+        if( (Job->Script = InitFind(Token)) == NULL ) {
+            PrintString("Unrecognized script (");
+            PrintString(Token);
+            PrintString("), INIT alone lists them.\r\n");
+            PrintString("Type '?' for help\r\n");
+            PrintCRLF();
+            return(true);
+            }
+
+        Job->SlaveAddr = 0xFF;
+        if( !ParseValue() ) {
+            if( Token[0] != 0 ) {
+                PrintString("Unrecognized slave addr (");
+                PrintString(Token);
+                PrintString("), must 2 hex chars.\r\n");
+                PrintString("Type '?' for help\r\n");
+                PrintCRLF();
+                return(true);
+                }
+            }
+        else Job->SlaveAddr = Value;
+
+        return(RunCommand(Job,InitJob));
+        }
+
+
+    //
+    // BENCH - Time reads from a slave, interrupt driven vs. polled
+    //
+    if( StrEQ(Command,"BENCH") ) {
+        if( !ParseSlaveAddr() ||
+            !ParseNBytes(BENCH_MAX) )
+            return(true);
+
+        Job->SlaveAddr = SlaveAddr;
+        Job->nBytes    = nBytes;
+        return(RunCommand(Job,BenchJob));
+        }
+
+
+    //
+    // AUTOTUNE - Find the fastest clean bus speed for a slave, and keep it as
+    //   its profile. Reads register 0 (4 bytes) unless told otherwise.
+    //
+    if( StrEQ(Command,"AUTOTUNE") ) {
+        if( !ParseSlaveAddr() )
+            return(true);
+
+        Job->Reg    = 0;
+        Job->nBytes = 4;
+
+        if( ParseValue() ) {
+            Job->Reg = Value;
+            if( ParseValue() ) {
+                if( Value == 0 || Value > Job->Size/2 ) {
+                    PrintString("nBytes too big (");
+                    PrintString(Token);
+                    PrintString("), must 1 to ");
+                    PrintH(Job->Size/2);
+                    PrintString(".\r\n");
+                    PrintString("Type '?' for help\r\n");
+                    PrintCRLF();
+                    return(true);
+                    }
+                Job->nBytes = Value;
+                Token = ParseToken();
+                }
+            }
+
+        if( Token[0] != 0 ) {
+            PrintString("Unrecognized value (");
+            PrintString(Token);
+            PrintString("), must 2 hex chars.\r\n");
+            PrintString("Type '?' for help\r\n");
+            PrintCRLF();
+            return(true);
+            }
+
+        Job->Sum = ConfigGetProfile(SlaveAddr);     // To put back if it fails
+
+        if( !ConfigSetProfile(SlaveAddr,AUTOTUNE_LOW) ) {
+            PrintString("No free profile, must <= ");
+            PrintD(I2C_PROFILES,0);
+            PrintString(" slaves.\r\n");
+            PrintCRLF();
+            return(true);
+            }
+
+        Job->SlaveAddr = SlaveAddr;
+        Job->Stop      = AutotuneStop;
+        return(RunCommand(Job,AutotuneJob));
+        }
+
+
+#ifdef DEBUG_I2C
+    //
+    // X - Do user-defined debug command
+    //
+    if( StrEQ(Command,"X") ) {
+        DumpDebug();
+        return(true);
+        }
+#endif
+
+
+    /////////////////////////////////////////////////////////////////////////////////////
+    //
+    // Regular commands follow
+    //
+
+    //
+    // HE - Help screen
+    //
+    if( StrEQ(Command,"H") ||
+        StrEQ(Command,"?" ) ) {
+        PrintCRLF();
+        PrintString(HELP_SCREEN);
+        PrintCRLF();
+        return(true);
+        }
+
+
+    //
+    // Not a recognized command. Let the user know he goofed.
+    //
+    PrintStringP(PSTR(BEEP));
+    PrintStringP(PSTR("Unrecognized Command \""));
+    PrintString (Command);
+    PrintStringP(PSTR("\"\r\n"));
+    PrintString("Type '?' for help\r\n");
+    PrintCRLF();
+    return(true);
     }
@@ -0,0 +1,135 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2015 Peter Walsh, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      Init.c
+//
+//  DESCRIPTION
+//
+//      Device init scripts, kept in flash
+//
+//      See Init.h for the step format.
+//
+//  VERSION:    2026.10.17
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+
+#include "Init.h"
+
+typedef struct {
+    PGM_P           Name;
+    const uint8_t  *Steps;
+    } INIT_SCRIPT;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// SSD1306 128x64 OLED (Adafruit and clones), charge pump on. A leading 00 says
+//   the rest of the write is commands, so it's the prefix of every write.
+//
+static const char    OLEDName[] PROGMEM = "OLED";
+static const uint8_t OLEDInit[] PROGMEM = {
+    INIT_PREFIX(0x00),                  // Commands follow
+    INIT_WRITE(0x3C,24),
+        0xAE,                           // Display off
+        0xD5, 0x80,                     // Clock divide
+        0xA8, 0x3F,                     // Multiplex 64
+        0xD3, 0x00,                     // No display offset
+        0x40,                           // Start line 0
+        0x8D, 0x14,                     // Charge pump on
+        0x20, 0x00,                     // Horizontal addressing
+        0xA1,                           // Segment remap
+        0xC8,                           // COM scan down
+        0xDA, 0x12,                     // COM pins
+        0x81, 0xCF,                     // Contrast
+        0xD9, 0xF1,                     // Precharge
+        0xDB, 0x40,                     // VCOM detect
+        0xA4,                           // Display from RAM
+        0xA6,                           // Normal (not inverse)
+    INIT_DELAY(100),                    // Let the charge pump come up
+    INIT_WRITE(0x3C,1), 0xAF,           // Display on
+    INIT_END,
+    };
+
+static const char    OLEDOffName[] PROGMEM = "OLEDOFF";
+static const uint8_t OLEDOff[]     PROGMEM = {
+    INIT_PREFIX(0x00),                  // Commands follow
+    INIT_WRITE(0x3C,1), 0xAE,           // Display off
+    INIT_WRITE(0x3C,2), 0x8D, 0x10,     // Charge pump off
+    INIT_END,
+    };
+
+static const INIT_SCRIPT InitScripts[] PROGMEM = {
+    { OLEDName,    OLEDInit },
+    { OLEDOffName, OLEDOff  },
+    };
+
+#define NUM_SCRIPTS (sizeof(InitScripts)/sizeof(InitScripts[0]))
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// InitFind - Find a built in script by name
+//
+// Inputs:      Name of script (case doesn't matter)
+//
+// Outputs:     Ptr to first step of script, in flash
+//              NULL if no such script
+//
+const uint8_t *InitFind(const char *Name) {
+    PGM_P   ScriptName;
+    uint8_t Index;
+
+    for( Index = 0; (ScriptName = InitName(Index)) != NULL; Index++ ) {
+        if( strcasecmp_P(Name,ScriptName) == 0 )
+            return(pgm_read_ptr(&InitScripts[Index].Steps));
+        }
+
+    return(NULL);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// InitName - Return the name of a built in script
+//
+// Inputs:      Index of script, from 0
+//
+// Outputs:     Name of script, in flash
+//              NULL past the last one
+//
+PGM_P InitName(uint8_t Index) {
+
+    if( Index >= NUM_SCRIPTS )
+        return(NULL);
+
+    return(pgm_read_ptr(&InitScripts[Index].Name));
+    }
@@ -0,0 +1,112 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2015 Peter Walsh, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      Init.h
+//
+//  SYNOPSIS
+//
+//      static const uint8_t OLEDInit[] PROGMEM = {
+//          INIT_WRITE(0x3C,3), 0x00, 0xAE, 0xA6,   // Write 3 bytes to 3C
+//          INIT_DELAY(10),                         // Wait 10 ms
+//          INIT_END,
+//          };
+//
+//      Script = InitFind("OLED");              // Built in script, by name
+//      Name   = InitName(Index);               // Name of Index'th script, for listing
+//
+//  DESCRIPTION
+//
+//      Device init scripts, kept in flash
+//
+//      Displays, codecs and power chips want long constant byte sequences
+//        written before they do anything. An init script is a list of steps in
+//        flash: writes, each one transfer to one slave, and delays between them.
+//        The writes go out with I2C_PGM, straight from flash, so a script
+//        costs no RAM however long it is.
+//
+//      Each step starts with an op byte. A slave address (0x00-0x7F) is a
+//        write, followed by the byte count and then the data. INIT_OP_DELAY
+//        is followed by the delay in ms, and INIT_OP_END ends the script.
+//        INIT_OP_PREFIX is followed by a byte sent ahead of the data of every
+//        write after it, for slaves which want a control byte in front of each
+//        write (the SSD1306's 00, "commands follow"). It's kept in RAM and
+//        sent as a segment of its own, so the data still comes from flash.
+//
+//      The built in scripts are in Init.c. Add new ones to InitScripts[].
+//
+//  VERSION:    2026.10.17
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INIT_H
+#define INIT_H
+
+#include <stdint.h>
+
+#include <avr/pgmspace.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// Script step ops. Anything below 0x80 is the slave address of a write.
+//
+#define INIT_OP_PREFIX  0xFD            // Followed by byte sent ahead of later writes
+#define INIT_OP_DELAY   0xFE            // Followed by ms
+#define INIT_OP_END     0xFF
+
+#define INIT_WRITE(_a_,_n_) (_a_), (_n_)
+#define INIT_PREFIX(_b_)    INIT_OP_PREFIX, (_b_)
+#define INIT_DELAY(_ms_)    INIT_OP_DELAY, (_ms_)
+#define INIT_END            INIT_OP_END
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// InitFind - Find a built in script by name
+//
+// Inputs:      Name of script (case doesn't matter)
+//
+// Outputs:     Ptr to first step of script, in flash
+//              NULL if no such script
+//
+const uint8_t *InitFind(const char *Name);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// InitName - Return the name of a built in script
+//
+// Inputs:      Index of script, from 0
+//
+// Outputs:     Name of script, in flash
+//              NULL past the last one
+//
+PGM_P InitName(uint8_t Index);
+
+#endif  // INIT_H - entire file
@@ -0,0 +1,602 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2015 Peter Walsh, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      Job.c
+//
+//  DESCRIPTION
+//
+//      Job table, bus lock, and output of job results
+//
+//      See Job.h for a description of the interface.
+//
+//  VERSION:    2026.10.17
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+#include <avr/interrupt.h>
+
+#include "Serial.h"
+#include "UART.h"
+#include "GetLine.h"
+#include "Job.h"
+#include "Log.h"
+#include "BusPirate.h"
+#include "Pool.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data declarations
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+JOB Jobs[MAX_JOBS];
+
+//
+// Job buffers come from the pool. Background jobs each take MAX_BGBYTES from the
+//   top, and the foreground takes what it can get up to MAX_RWBYTES from the
+//   bottom, which must be at least MAX_BGBYTES. The check below only makes sure
+//   every job can have its smallest buffer: a large foreground buffer (which is
+//   kept until its report is printed) can still leave a background job without
+//   one, and NewJob() then refuses it.
+//
+#if POOL_SIZE < MAX_JOBS*MAX_BGBYTES
+#error "Pool too small for the job buffers"
+#endif
+
+//
+// Results of a transfer, waiting to be printed by the output task. There is one
+//   report per output channel, indexed by Job->Output.
+//
+typedef struct {
+    TASK         Task;          // Resume point of formatter
+    JOB         *Job;           // Job with results, NULL if idle
+    PGM_P        Title;         // Text before status, or NULL
+    I2C_STATUS   Status;        // Status to print
+    REPORT_STYLE Style;         // What to print
+    uint8_t      nBytes;        // Bytes of data in Job->Buffer
+    uint8_t      Index;         // Next byte to print
+    } REPORT;
+
+static REPORT Reports[OUTPUT_BULK+1];
+
+char *StatusText[] = {
+    "I2C_COMPLETE",
+    "I2C_WORKING",
+    "I2C_NO_SLAVE_ACK",
+    "I2C_SLAVE_DATA_NACK",
+    "I2C_REP_START",
+    "I2C_MT_ARB_LOST",
+    "I2C_BUS_ERROR",
+    "I2C_CANCELLED",
+    "I2C_VERIFY_FAILED",
+    "I2C_TIMEOUT" };
+
+static uint8_t DoneJob(JOB *Job);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// PrintJobID - Print "[n] " for background jobs
+//
+// Inputs:      Job to identify
+//
+// Outputs:     None.
+//
+void PrintJobID(JOB *Job) {
+
+    if( Job->Output == OUTPUT_TTY )
+        return;
+
+    PrintChar('[');
+    PrintD(Job-Jobs,0);
+    PrintString("] ");
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// PrintStatus - Print out a text representation of an I2C status
+//
+// Inputs:      Status to print
+//
+// Outputs:     None.
+//
+void PrintStatus(I2C_STATUS Status) {
+
+    if( Status <= I2C_LAST_ERROR ) PrintString(StatusText[Status-I2C_COMPLETE]);
+    else                           PrintString("????");
+    PrintString(" (");
+
+    PrintH(Status);
+    PrintString(")\r\n");
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// FreeJobBuffers - Return the buffers of finished jobs to the pool
+//
+// A job's transfer (after an abort) and its data listing can both outlive the
+//   job, so the buffer is only given back once they are done with it too.
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void FreeJobBuffers(void) {
+    JOB *Job;
+
+    for( Job = Jobs; Job < &Jobs[MAX_JOBS]; Job++ ) {
+        if( Job->Buffer != NULL && Job->Run == NULL && XferIdle(Job) &&
+            Reports[Job->Output].Job != Job ) {
+            PoolFree(Job->Buffer,Job->Size);
+            Job->Buffer = NULL;
+            }
+        }
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// NewJob - Return a free job slot
+//
+// The job's buffer is borrowed from the pool, and given back some time after
+//   the job ends. A foreground buffer may be smaller than MAX_RWBYTES while
+//   background jobs are running, and Size says how big it is.
+//
+// Inputs:      Command line (start is kept for the "jobs" listing)
+//              TRUE if job is to run in the background
+//
+// Outputs:     Ptr to job
+//              NULL if no free slot or buffer (message has been printed)
+//
+JOB *NewJob(const char *Line, bool Background) {
+    JOB *Job = &FgJob;
+
+    FreeJobBuffers();
+
+    if( Background ) {
+        for( Job = &Jobs[1]; Job < &Jobs[MAX_JOBS]; Job++ ) {
+            if( Job->Run == NULL && XferIdle(Job) )
+                break;
+            }
+
+        if( Job == &Jobs[MAX_JOBS] ) {
+            PrintString("Too many jobs, must <= ");
+            PrintD(MAX_JOBS-1,0);
+            PrintString(".\r\n");
+            PrintString("Type 'jobs' for a list\r\n");
+            PrintCRLF();
+            return(NULL);
+            }
+
+        Job->Output = OUTPUT_BULK;
+        if( Job->Buffer == NULL )
+            Job->Buffer = PoolAlloc(MAX_BGBYTES,MAX_BGBYTES,true,&Job->Size);
+        }
+    else {
+        Job->Output = OUTPUT_TTY;
+        if( Job->Buffer == NULL )
+            Job->Buffer = PoolAlloc(MAX_BGBYTES,MAX_RWBYTES,false,&Job->Size);
+        }
+
+    if( Job->Buffer == NULL ) {
+        PrintString("No buffer free, wait for a job to finish.\r\n");
+        PrintString("Type 'jobs' for a list\r\n");
+        PrintCRLF();
+        return(NULL);
+        }
+
+    Job->Period = 0;
+    Job->Stop   = NULL;
+
+    strncpy(Job->Label,Line,sizeof(Job->Label)-1);
+    Job->Label[sizeof(Job->Label)-1] = 0;
+
+    return(Job);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// StartJob - Start a job running
+//
+// Inputs:      Job to start
+//              Job body
+//
+// Outputs:     None.
+//
+void StartJob(JOB *Job, JOB_FN Run) {
+
+    TASK_INIT(Job->Task);
+    Job->Run = Run;
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// AbortJob - Stop a job wherever it is
+//
+// A queued transfer is cancelled. One already on the bus runs to completion on
+//   its own, except that a raw session is stopped (once its current step is done,
+//   by the driver). Then the job's Stop function, if any, undoes whatever
+//   the job was in the middle of.
+//
+// Inputs:      Job to stop
+//
+// Outputs:     None.
+//
+void AbortJob(JOB *Job) {
+
+    I2CCancel(&Job->Xfer);
+
+    //
+    // A raw session still working after the cancel has the bus
+    //
+    cli();
+    if( (Job->Xfer.Flags & I2C_RAW) && Job->Xfer.Status == I2C_WORKING )
+        I2CRawStop();
+    sei();
+
+    if( Reports[Job->Output].Job == Job )
+        Reports[Job->Output].nBytes = 0;    // Cut data listing short
+
+    if( Job->Run != NULL && Job->Stop != NULL )
+        Job->Stop(Job);
+
+    Job->Run = NULL;
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// SubmitXfer - Queue a bus transfer for a job
+//
+// Inputs:      Job doing the transfer
+//              Slave address
+//              # bytes to write, and data
+//              # bytes to read,  and where to put it
+//              Transfer flags (see I2C.h)
+//
+// Outputs:     None.
+//
+void SubmitXfer(JOB *Job, uint8_t SlaveAddr, uint8_t WrBytes, uint8_t *WrBuffer,
+                                             uint8_t RdBytes, uint8_t *RdBuffer,
+                                             uint8_t Flags) {
+    I2C_XFER *Xfer = &Job->Xfer;
+
+    Xfer->SlaveAddr = SlaveAddr;
+    Xfer->WrBytes   = WrBytes;
+    Xfer->WrBuffer  = WrBuffer;
+    Xfer->RdBytes   = RdBytes;
+    Xfer->RdBuffer  = RdBuffer;
+    Xfer->Flags     = Flags;
+    Xfer->Chain     = NULL;
+    Xfer->Segs      = NULL;
+
+    SubmitChain(Job);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// SubmitChain - Queue a chain of bus transfers for a job
+//
+// Inputs:      Job doing the transfer (Job->Xfer filled in)
+//
+// Outputs:     None.
+//
+void SubmitChain(JOB *Job) {
+
+    Job->Xfer.Priority = Job->Output == OUTPUT_TTY ? I2C_PRI_HIGH : I2C_PRI_LOW;
+
+    I2CSubmit(&Job->Xfer);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// ReportIdle - Return TRUE if the job may post a report
+// ReportDone - Return TRUE if the job's last report has been printed
+//
+// Inputs:      Job to check
+//
+// Outputs:     TRUE/FALSE as above
+//
+bool ReportIdle(JOB *Job) { return Reports[Job->Output].Job == NULL; }
+bool ReportDone(JOB *Job) { return Reports[Job->Output].Job != Job;  }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// PostReport - Hand the results of a transfer to the output task
+//
+// Inputs:      Job with results (data in Job->Buffer)
+//              Text to print before the status, or NULL
+//              Status of transfer
+//              What to print
+//
+// Outputs:     None.
+//
+void PostReport(JOB *Job, PGM_P Title, I2C_STATUS Status, REPORT_STYLE Style) {
+    REPORT *Report = &Reports[Job->Output];
+
+    Report->Title  = Title;
+    Report->Status = Status;
+    Report->Style  = Style;
+    Report->nBytes = Job->nBytes;
+    Report->Index  = 0;
+    Report->Job    = Job;
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// FormatReport - Print one report
+//
+// Formats the report one line at a time, as room on the output channel allows,
+//   so that a long data listing doesn't hold up the other tasks.
+//
+// Inputs:      Report to print (output channel has been selected)
+//
+// Outputs:     Task state
+//
+static uint8_t FormatReport(REPORT *Report) {
+
+    TASK_BEGIN(Report->Task);
+    while(1) {
+        TASK_WAIT(Report->Task,Report->Job != NULL && OutputRoom() >= MAX_LINE);
+
+        PrintJobID(Report->Job);
+
+        //
+        // Samples are printed on one line: "P <slave>: <byte> <byte> ..."
+        //
+        if( Report->Style == REPORT_SAMPLE ) {
+            PrintString("P ");
+            PrintH(Report->Job->SlaveAddr);
+            PrintString(": ");
+            if( Report->Status == I2C_COMPLETE ) {
+                for( Report->Index = 0; Report->Index < Report->nBytes; Report->Index++ ) {
+                    PrintH(Report->Job->Buffer[Report->Index]);
+                    PrintChar(' ');
+                    }
+                PrintCRLF();
+                }
+            else PrintStatus(Report->Status);
+            Report->Job = NULL;
+            continue;
+            }
+
+        if( Report->Title )
+            PrintStringP(Report->Title);
+        PrintStatus(Report->Status);
+
+        if( Report->Style == REPORT_DATA && Report->Status == I2C_COMPLETE ) {
+            PrintJobID(Report->Job);
+            PrintString("Data:\r\n");
+
+            //
+            // Note that AbortJob() may set nBytes to zero to cut this short.
+            //
+            while(1) {
+                TASK_WAIT(Report->Task,OutputRoom() >= MAX_LINE);
+                if( Report->Index >= Report->nBytes )
+                    break;
+                PrintJobID(Report->Job);
+                PrintString("  0x");
+                PrintH(Report->Index);
+                PrintString(": 0x");
+                PrintH(Report->Job->Buffer[Report->Index]);
+                PrintString("  0b");
+                PrintB(Report->Job->Buffer[Report->Index]);
+                PrintCRLF();
+                Report->Index++;
+                }
+
+            if( Report->nBytes != 0 )
+                PrintCRLF();
+            }
+
+        Report->Job = NULL;
+        }
+    TASK_END(Report->Task);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// OutputTask - Print job results, and move bulk output to the UART
+//
+// Background output only goes out while there is no foreground report, so a
+//   foreground listing is never broken up by background data.
+//
+// Inputs:      None.
+//
+// Outputs:     Task state
+//
+uint8_t OutputTask(void) {
+    uint8_t Ran;
+
+    if( LogActive() || BPActive() )     // UART belongs to the log, or Bus Pirate
+        return(TASK_WAITING);
+
+    Ran  = FormatReport(&Reports[OUTPUT_TTY]);
+
+    SetOutput(OUTPUT_BULK);
+    Ran |= FormatReport(&Reports[OUTPUT_BULK]);
+    SetOutput(OUTPUT_TTY);
+
+    if( Reports[OUTPUT_TTY].Job == NULL && FlushBulk() )
+        Ran = TASK_YIELDED;
+
+    return(Ran);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// RunJob - Give a job one turn
+//
+// A background job which finishes is given one more body (DoneJob) to print
+//   its completion notice.
+//
+// Inputs:      Job to run
+//
+// Outputs:     Task state (TASK_DONE when the job finishes)
+//
+static uint8_t RunJob(JOB *Job) {
+    uint8_t State;
+
+    if( Job->Run == NULL )
+        return(TASK_WAITING);
+
+    SetOutput(Job->Output);
+    State = Job->Run(Job);
+    SetOutput(OUTPUT_TTY);
+
+    if( State == TASK_DONE ) {
+        if( Job->Output == OUTPUT_BULK && Job->Run != DoneJob ) {
+            StartJob(Job,DoneJob);
+            return(TASK_YIELDED);
+            }
+        Job->Run = NULL;
+        }
+
+    return(State);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// DoneJob - Announce the end of a background job
+//
+// Inputs:      Job which finished
+//
+// Outputs:     Task state
+//
+static uint8_t DoneJob(JOB *Job) {
+
+    TASK_BEGIN(Job->Task);
+    TASK_WAIT(Job->Task,OutputRoom() >= MAX_LINE);
+    PrintJobID(Job);
+    PrintString("Done    ");
+    PrintString(Job->Label);
+    PrintCRLF();
+    TASK_END(Job->Task);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// CommandTask - Run the foreground job, prompt when done
+// JobsTask    - Run the background jobs
+//
+// Inputs:      None.
+//
+// Outputs:     Task state
+//
+uint8_t CommandTask(void) {
+    uint8_t State = RunJob(&FgJob);
+
+    if( State == TASK_DONE )
+        Prompt();
+
+    return(State);
+    }
+
+uint8_t JobsTask(void) {
+    uint8_t Ran = TASK_WAITING;
+
+    for( JOB *Job = &Jobs[1]; Job < &Jobs[MAX_JOBS]; Job++ )
+        Ran |= RunJob(Job);
+
+    return(Ran);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// ListJobs - Print the background jobs ("jobs" command)
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void ListJobs(void) {
+
+    for( JOB *Job = &Jobs[1]; Job < &Jobs[MAX_JOBS]; Job++ ) {
+        if( Job->Run == NULL || Job->Run == DoneJob )
+            continue;
+        PrintChar('[');
+        PrintD(Job-Jobs,0);
+        PrintString("] Running ");
+        PrintString(Job->Label);
+        PrintCRLF();
+        }
+    PrintCRLF();
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// KillJob - Stop a background job by ID ("kill" command)
+//
+// Inputs:      Job ID, as printed when the job started
+//
+// Outputs:     TRUE  if job was killed
+//              FALSE if no such job
+//
+bool KillJob(uint8_t ID) {
+
+    if( ID == 0 || ID >= MAX_JOBS || Jobs[ID].Run == NULL )
+        return(false);
+
+    AbortJob(&Jobs[ID]);
+    return(true);
+    }
@@ -0,0 +1,291 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2015 Peter Walsh, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      Job.h
+//
+//  SYNOPSIS
+//
+//      static uint8_t ReadJob(JOB *Job) {      // Job body, a task (see Task.h)
+//          TASK_BEGIN(Job->Task);
+//          TASK_WAIT(Job->Task,XferIdle(Job));
+//          SubmitXfer(Job,Job->SlaveAddr,0,NULL,Job->nBytes,Job->Buffer,0);
+//          TASK_WAIT(Job->Task,XferIdle(Job));
+//          Job->Status = Job->Xfer.Status;
+//          TASK_WAIT(Job->Task,ReportIdle(Job));
+//          PostReport(Job,NULL,Job->Status,REPORT_DATA);
+//          TASK_END(Job->Task);
+//          }
+//
+//      JOB *Job = NewJob(Line,Background);     // Find a free job slot
+//      Job->SlaveAddr = ...                    // Fill in arguments
+//      StartJob(Job,ReadJob);                  // Run it
+//
+//      Job->Stop = ...                         // (Set by the job) Undo, if aborted
+//      AbortJob(Job);                          // Stop it early
+//
+//  DESCRIPTION
+//
+//      Bus commands run as jobs. Slot zero is the foreground job, which belongs to
+//        the command line; the others are background jobs started with a trailing
+//        '&', and are identified by their slot number.
+//
+//      Jobs queue their bus transfers with the I2C driver, foreground jobs at high
+//        priority and background jobs at low (see I2C.h). Results are handed to
+//        the output task through PostReport(). Background output goes to the bulk
+//        channel (see Serial.h), so interactive output always goes out first.
+//
+//  VERSION:    2026.10.17
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef JOB_H
+#define JOB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <avr/pgmspace.h>
+
+#include "Task.h"
+#include "I2C.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+#define MAX_JOBS        4               // Foreground job plus 3 background jobs
+#define MAX_RWBYTES     0xF0            // Most data for a foreground job
+#define MAX_BGBYTES     32              // Size of background data buffers
+#define JOB_LABEL_SIZE  12              // Chars of command line kept for "jobs"
+
+//
+// Tasks must not block on output. A task waits until the output channel has room
+//   for this many chars, then prints (at most) one line.
+//
+#define MAX_LINE        48
+
+typedef struct JOB JOB;
+typedef uint8_t (*JOB_FN)(JOB *Job);
+typedef void    (*JOB_STOP)(JOB *Job);
+
+struct JOB {
+    TASK        Task;                   // Resume point of job
+    JOB_FN      Run;                    // Job body, NULL if slot is free
+    JOB_STOP    Stop;                   // Cleanup if aborted, or NULL
+    uint8_t     Output;                 // OUTPUT_TTY (foreground) or OUTPUT_BULK
+    uint8_t     SlaveAddr;              // Slave to talk to
+    uint8_t     Reg;                    // Starting register
+    uint8_t     nBytes;                 // Number of bytes to transfer
+    uint8_t     Index;                  // Loop counter
+    uint8_t     Count;                  // Number of results
+    bool        RepStart;               // TRUE if register read uses repeated start
+    I2C_STATUS  Status;                 // Status of last transfer
+    I2C_XFER    Xfer;                   // Bus transfer
+    uint8_t     Period;                 // Sample period in ms, 0 if not sampling
+    uint32_t    NextTime;               // Time of next sample
+    uint16_t    Addr;                   // Next address (checksum)
+    uint16_t    Left;                   // Bytes still to read (checksum)
+    uint8_t     AddrBytes;              // 1 or 2 byte addresses (checksum)
+    uint8_t     AddrBuf[2];             // Address as sent, MSB first (checksum)
+    uint8_t     Mode;                   // Command option (checksum type, write flags)
+    uint32_t    Sum;                    // Running checksum (old profile, autotune)
+    uint8_t     Errors[2];              // Failed, bad data (autotune)
+    const uint8_t *Script;              // Next step, in flash (init scripts)
+    uint8_t    *Buffer;                 // Data to send/receive
+    uint8_t     Size;                   // Size of Buffer
+    char        Label[JOB_LABEL_SIZE];  // Start of command line
+    };
+
+extern JOB Jobs[MAX_JOBS];
+
+#define FgJob   (Jobs[0])
+
+typedef enum {
+    REPORT_STATUS,                      // Status line only
+    REPORT_DATA,                        // Status line plus data listing
+    REPORT_SAMPLE,                      // One line sample
+    } REPORT_STYLE;
+
+extern char *StatusText[];
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// NewJob - Return a free job slot
+//
+// The slot isn't taken until StartJob() is called, so a caller which finds an
+//   error in the command line can simply walk away.
+//
+// Inputs:      Command line (start is kept for the "jobs" listing)
+//              TRUE if job is to run in the background
+//
+// Outputs:     Ptr to job
+//              NULL if no free slot or buffer (message has been printed)
+//
+JOB *NewJob(const char *Line, bool Background);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// FreeJobBuffers - Return the buffers of finished jobs to the pool
+//
+// Buffers are given back lazily; NewJob() does this before taking one.
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void FreeJobBuffers(void);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// StartJob - Start a job running
+// AbortJob - Stop a job wherever it is
+//
+// A job which leaves something to undo if stopped early sets Job->Stop, and
+//   clears it once there's nothing to undo. AbortJob() calls it.
+//
+// Inputs:      Job
+//              Job body (StartJob only)
+//
+// Outputs:     None.
+//
+void StartJob(JOB *Job, JOB_FN Run);
+void AbortJob(JOB *Job);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// SubmitXfer - Queue a bus transfer for a job
+// XferIdle   - Return TRUE if the job's transfer is done
+//
+// The job must wait for XferIdle() before submitting: an aborted job's transfer
+//   may still be on the bus when its slot is reused.
+//
+// Inputs:      Job doing the transfer
+//              Slave address
+//              # bytes to write, and data
+//              # bytes to read,  and where to put it
+//              Transfer flags (see I2C.h)
+//
+// Outputs:     None.
+//
+void SubmitXfer(JOB *Job, uint8_t SlaveAddr, uint8_t WrBytes, uint8_t *WrBuffer,
+                                             uint8_t RdBytes, uint8_t *RdBuffer,
+                                             uint8_t Flags);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// SubmitChain - Queue a chain of bus transfers for a job
+//
+// Job->Xfer is the first transfer, filled in by the caller and chained to the
+//   rest (see I2C.h). XferIdle() goes TRUE when the whole chain is done.
+//
+// Inputs:      Job doing the transfer
+//
+// Outputs:     None.
+//
+void SubmitChain(JOB *Job);
+
+#define XferIdle(_j_)   ((_j_)->Xfer.Status != I2C_WORKING)
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// ReportIdle - Return TRUE if the job may post a report
+// ReportDone - Return TRUE if the job's last report has been printed
+// PostReport - Hand the results of a transfer to the output task
+//
+// A job must wait for ReportIdle() before posting, and must not touch its buffer
+//   again until ReportDone().
+//
+// Inputs:      Job with results (data in Job->Buffer)
+//              Text to print before the status, or NULL
+//              Status of transfer
+//              What to print
+//
+// Outputs:     None.
+//
+bool ReportIdle(JOB *Job);
+bool ReportDone(JOB *Job);
+void PostReport(JOB *Job, PGM_P Title, I2C_STATUS Status, REPORT_STYLE Style);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// PrintJobID - Print "[<id>] " if the job runs in the background
+//
+// Inputs:      Job
+//
+// Outputs:     None.
+//
+void PrintJobID(JOB *Job);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// PrintStatus - Print out a text representation of an I2C status
+//
+// Inputs:      Status to print
+//
+// Outputs:     None.
+//
+void PrintStatus(I2C_STATUS Status);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// ListJobs - Print the background jobs ("jobs" command)
+// KillJob  - Stop a background job by ID ("kill" command)
+//
+// Inputs:      Job ID (KillJob only)
+//
+// Outputs:     TRUE  if job was killed
+//              FALSE if no such job (KillJob only)
+//
+void ListJobs(void);
+bool KillJob(uint8_t ID);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// CommandTask - Run the foreground job, prompt when done
+// JobsTask    - Run the background jobs
+// OutputTask  - Print job results, and move bulk output to the UART
+//
+// Inputs:      None.
+//
+// Outputs:     Task state
+//
+uint8_t CommandTask(void);
+uint8_t JobsTask(void);
+uint8_t OutputTask(void);
+
+#endif  // JOB_H - entire file
@@ -0,0 +1,271 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2015 Peter Walsh, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      Log.c
+//
+//  DESCRIPTION
+//
+//      Binary sample log
+//
+//      See Log.h for a description of the interface and the stream format.
+//
+//  VERSION:    2026.10.17
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+
+#include "Timer.h"
+#include "Task.h"
+#include "UART.h"
+#include "Log.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data declarations
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#define LOG_MAX_RECORD  (1 + 5 + 2*LOG_MAX_VALUES)  // ID, time, values
+
+static struct {
+    bool     Active;                            // TRUE if logging
+    uint32_t LastTime;                          // Time of previous record
+    uint8_t  Type[LOG_CHANNELS];                // 'T', 'A', 'P', or 0 if not logged
+    uint8_t  Prev[LOG_CHANNELS][LOG_MAX_VALUES];// Previous values, per channel
+    } Log;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// PutVarint - Send an unsigned number as a varint
+// PutZigZag - Send a   signed number as a zig-zag varint
+//
+// Inputs:      Number to send
+//
+// Outputs:     None.
+//
+static void PutVarint(uint32_t Value) {
+
+    while( Value >= 0x80 ) {
+        PutUARTByteW((Value & 0x7F) | 0x80);
+        Value >>= 7;
+        }
+    PutUARTByteW(Value);
+    }
+
+static void PutZigZag(int32_t Value) {
+
+    PutVarint(((uint32_t) Value << 1) ^ (uint32_t) (Value >> 31));
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// PutChannel - Send one channel description of the header
+//
+// Inputs:      Channel ID
+//              Type ('T', 'A', or 'P')
+//              Slave, register, and # values per record
+//
+// Outputs:     None.
+//
+static void PutChannel(uint8_t ID, uint8_t Type, uint8_t SlaveAddr, uint8_t Reg, uint8_t nValues) {
+
+    Log.Type[ID] = Type;
+
+    PutUARTByteW(ID);
+    PutUARTByteW(Type);
+    PutUARTByteW(SlaveAddr);
+    PutUARTByteW(Reg);
+    PutUARTByteW(nValues);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// LogStart - Send the log header, start logging
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void LogStart(void) {
+    uint8_t nChannels = 0;
+    uint8_t SlaveAddr;
+    uint8_t Reg;
+    uint8_t nBytes;
+    JOB    *Job;
+
+    memset(&Log,0,sizeof(Log));
+
+    //
+    // Count the channels first, the count goes before the list
+    //
+    for( uint8_t i = 0; i < NUM_TRIGGERS; i++ ) {
+        if( GetTrigger(i,&SlaveAddr,&Reg,&nBytes) != TRIG_OFF )
+            nChannels++;
+        }
+
+    for( Job = &Jobs[1]; Job < &Jobs[MAX_JOBS]; Job++ ) {
+        if( Job->Run != NULL && Job->Period != 0 )
+            nChannels++;
+        }
+
+    PutUARTByteW('I');
+    PutUARTByteW('2');
+    PutUARTByteW('C');
+    PutUARTByteW('L');
+    PutUARTByteW(LOG_VERSION);
+    PutUARTByteW(nChannels);
+
+    for( uint8_t i = 0; i < NUM_TRIGGERS; i++ ) {
+        TRIG_MODE Mode = GetTrigger(i,&SlaveAddr,&Reg,&nBytes);
+
+        if     ( Mode == TRIG_ALERT ) PutChannel(i,'A',SMBUS_ARA,Reg,nBytes+1);
+        else if( Mode != TRIG_OFF   ) PutChannel(i,'T',SlaveAddr,Reg,nBytes);
+        }
+
+    for( Job = &Jobs[1]; Job < &Jobs[MAX_JOBS]; Job++ ) {
+        if( Job->Run != NULL && Job->Period != 0 )
+            PutChannel(JobChannel(Job),'P',Job->SlaveAddr,Job->Reg,Job->nBytes);
+        }
+
+    Log.LastTime = TimerUS();
+    Log.Active   = true;
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// LogStop - Send the end marker, return the UART to text
+//
+// Samples not yet sent are thrown away.
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void LogStop(void) {
+    SAMPLE Sample;
+
+    while( GetSample(&Sample) )
+        ;
+
+    PutUARTByteW(LOG_END);
+    Log.Active = false;
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// LogActive - Return TRUE if the log is running
+//
+// Inputs:      None.
+//
+// Outputs:     TRUE if log is running
+//
+bool LogActive(void) { return(Log.Active); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// PutRecord - Send one sample as a log record
+//
+// Samples aren't always finished in time order (a polling job's read can finish
+//   after a later trigger edge), hence the signed time delta.
+//
+// Inputs:      Sample to send
+//
+// Outputs:     None.
+//
+static void PutRecord(SAMPLE *Sample) {
+    uint8_t  ID   = Sample->Channel;
+    uint8_t *Prev = Log.Prev[ID];
+
+    if( Log.Type[ID] == 0 )
+        return;
+
+    if( Sample->Status != I2C_COMPLETE ) {
+        PutUARTByteW(ID | LOG_ERROR);
+        PutZigZag(Sample->Time - Log.LastTime);
+        Log.LastTime = Sample->Time;
+        PutUARTByteW(Sample->Status);
+        return;
+        }
+
+    PutUARTByteW(ID);
+    PutZigZag(Sample->Time - Log.LastTime);
+    Log.LastTime = Sample->Time;
+
+    if( Log.Type[ID] == 'A' ) {
+        PutZigZag((int16_t) Sample->SlaveAddr - *Prev);
+        *Prev++ = Sample->SlaveAddr;
+        }
+
+    for( uint8_t i = 0; i < Sample->nBytes; i++ ) {
+        PutZigZag((int16_t) Sample->Data[i] - *Prev);
+        *Prev++ = Sample->Data[i];
+        }
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// LogTask - Send finished samples as log records
+//
+// A record is only started if the UART has room for the largest one, so the
+//   task never blocks.
+//
+// Inputs:      None.
+//
+// Outputs:     Task state
+//
+uint8_t LogTask(void) {
+    uint8_t Ran = TASK_WAITING;
+    SAMPLE  Sample;
+
+    if( !Log.Active )
+        return(TASK_WAITING);
+
+    while( UARTRoom() >= LOG_MAX_RECORD && GetSample(&Sample) ) {
+        PutRecord(&Sample);
+        Ran = TASK_YIELDED;
+        }
+
+    return(Ran);
+    }
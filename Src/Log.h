@@ -0,0 +1,148 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2015 Peter Walsh, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      Log.h
+//
+//  SYNOPSIS
+//
+//      LogStart();                             // Send header, start logging
+//      LogTask();                              // Send logged samples
+//      LogStop();                              // Send end marker, back to text
+//
+//      if( LogActive() ) ...                   // TRUE if UART is in log mode
+//
+//  DESCRIPTION
+//
+//      Binary sample log
+//
+//      Printed samples cost about 26 chars per data byte, which caps the sample
+//        rate at a few hundred per second. In log mode the UART carries a compact
+//        binary stream instead, and the console ignores everything except ESC.
+//
+//      The stream is a header, any number of records, and an end marker. All
+//        multibyte numbers are varints: 7 bits per byte, low bits first, with
+//        the top bit set on every byte but the last. Signed numbers are zig-zag
+//        encoded first (0,-1,1,-2,... => 0,1,2,3,...) so small values of either
+//        sign stay small.
+//
+//      Header:
+//
+//          'I' '2' 'C' 'L'                     Magic
+//          LOG_VERSION
+//          # channels
+//          per channel: ID Type Slave Reg nValues
+//
+//        Type is 'T' (pin trigger), 'A' (SMBus alert) or 'P' (polling job). For
+//        alert channels the first value is the address of the responder, and
+//        Slave is SMBUS_ARA.
+//
+//      Record:
+//
+//          ID                                  Channel, LOG_ERROR set on error
+//          zig-zag varint                      Time since previous record, in us
+//          nValues zig-zag varints             Change in each value since the
+//                                                channel's previous record
+//        or
+//          status byte                         (LOG_ERROR records)
+//
+//      End marker:
+//
+//          LOG_END
+//
+//      A typical 2 byte sample takes 4 or 5 bytes, against 20 or so as text.
+//
+//      See Tools/I2CLog.c for a decoder which converts the stream to CSV.
+//
+//  VERSION:    2026.10.17
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LOG_H
+#define LOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "Job.h"
+#include "Trigger.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// Log channels: one per trigger, then one per background job slot
+//
+#define LOG_VERSION     1
+
+#define LOG_CHANNELS    (NUM_TRIGGERS+MAX_JOBS-1)
+#define LOG_MAX_VALUES  (MAX_TRIGBYTES+1)           // Alert: responder + data
+
+#define LOG_ERROR       0x80                        // Record carries a status
+#define LOG_END         0xFF                        // End of stream
+
+#define JobChannel(_j_) (NUM_TRIGGERS+((_j_)-Jobs)-1)
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// LogStart - Send the log header, start logging
+// LogStop  - Send the end marker, return the UART to text
+//
+// Channels are the triggers which are turned on and the polling jobs which are
+//   running when the log starts.
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void LogStart(void);
+void LogStop(void);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// LogActive - Return TRUE if the log is running
+//
+// Inputs:      None.
+//
+// Outputs:     TRUE if log is running
+//
+bool LogActive(void);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// LogTask - Send finished samples as log records
+//
+// Inputs:      None.
+//
+// Outputs:     Task state
+//
+uint8_t LogTask(void);
+
+#endif  // LOG_H - entire file
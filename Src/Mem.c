@@ -0,0 +1,98 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2015 Peter Walsh, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      Mem.c
+//
+//  DESCRIPTION
+//
+//      RAM usage and stack depth
+//
+//      See Mem.h for a description of the interface.
+//
+//  VERSION:    2026.10.17
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include <avr/io.h>
+
+#include "Mem.h"
+
+//
+// From the linker: the end of static data, and so the start of free RAM
+//
+extern uint8_t __heap_start;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// MemPaint - Paint free RAM, right after reset
+//
+// Runs from .init3, after the stack pointer is set and before .data and .bss
+//   are set up. Nothing is on the stack yet, so all of the RAM above static data
+//   is painted. Naked, since the init sections fall through into each other.
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+static void MemPaint(void) __attribute__ ((naked, used, section (".init3")));
+
+static void MemPaint(void) {
+    uint8_t *Ptr;
+
+    for( Ptr = &__heap_start; Ptr <= (uint8_t *) RAMEND; Ptr++ )
+        *Ptr = MEM_PAINT;
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// MemGetStats - Get RAM usage
+//
+// The scan stops at the current stack pointer, since anything above it is in
+//   use anyway.
+//
+// Inputs:      Where to put the stats
+//
+// Outputs:     None.
+//
+void MemGetStats(MEM_STATS *Stats) {
+    uint8_t *Ptr = &__heap_start;
+    uint16_t Top = SP;
+
+    while( (uint16_t) Ptr <= Top && *Ptr == MEM_PAINT )
+        Ptr++;
+
+    Stats->Size     = RAMEND - RAMSTART + 1;
+    Stats->Static   = (uint16_t) &__heap_start - RAMSTART;
+    Stats->StackNow = RAMEND - Top;
+    Stats->StackMax = RAMEND - (uint16_t) Ptr + 1;
+    Stats->Free     = Ptr - &__heap_start;
+    }
@@ -0,0 +1,86 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2015 Peter Walsh, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      Mem.h
+//
+//  SYNOPSIS
+//
+//      MemGetStats(&Stats);                    // RAM use, stack high water mark
+//
+//  DESCRIPTION
+//
+//      RAM usage and stack depth
+//
+//      Static data (.data, .bss and .noinit) sits at the bottom of RAM, and the
+//        stack grows down from the top. There's no heap, so everything between
+//        is free.
+//
+//      At reset, before the C runtime sets up RAM, the free space is painted
+//        with MEM_PAINT. The stack overwrites the paint as it grows, so the
+//        painted bytes still left at the bottom were never used, and give the
+//        deepest the stack has been since reset.
+//
+//  VERSION:    2026.10.17
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MEM_H
+#define MEM_H
+
+#include <stdint.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// Free RAM is painted with this at reset
+//
+#define MEM_PAINT       0xC5
+
+typedef struct {
+    uint16_t    Size;                   // Total RAM
+    uint16_t    Static;                 // .data, .bss and .noinit
+    uint16_t    StackNow;               // Stack in use now
+    uint16_t    StackMax;               // Deepest stack since reset
+    uint16_t    Free;                   // Never used since reset
+    } MEM_STATS;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// MemGetStats - Get RAM usage
+//
+// Scans the painted area, so takes a few hundred us with a lot of RAM free.
+//
+// Inputs:      Where to put the stats
+//
+// Outputs:     None.
+//
+void MemGetStats(MEM_STATS *Stats);
+
+#endif  // MEM_H - entire file
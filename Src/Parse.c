@@ -68,8 +68,9 @@
 //
 #define IsDelimiter(__char__)   strchr(DELIMITERS,__char__)
 
-static char *LineBuffer              NOINIT;
-static char  Token[MAX_TOKEN_LENGTH] NOINIT;
+static char *LineBuffer                NOINIT;
+static char *TokenStart                NOINIT;
+static char  Token[MAX_TOKEN_LENGTH+1] NOINIT;
 
 /////////////////////////////////////////////////////////////////////////////////
 //
@@ -88,6 +89,9 @@ void ParseInit(char *Buffer) {
 //
 // ParseToken - Return next token in command buffer
 //
+// A token longer than MAX_TOKEN_LENGTH is cut short, but all of it is used up.
+//   ParseLongToken() has the whole thing.
+//
 // Inputs:      None.
 //
 // Outputs:     Ptr to next token in command buffer
@@ -96,8 +100,6 @@ void ParseInit(char *Buffer) {
 char *ParseToken() {
     char    *TokenPtr = Token;
 
-    memset(Token,0,sizeof(Token));
-
     //
     // Start by skipping over any existing delimiters.
     //
@@ -107,15 +109,51 @@ char *ParseToken() {
     while( *LineBuffer != 0 && IsDelimiter(*LineBuffer) )
         LineBuffer++;
 
+    TokenStart = LineBuffer;
+
     //
-    // Now move token chars into Token array, while keeping track of
-    //   lengths and such
+    // Now move token chars into Token array, in one pass
     //
-    while( *LineBuffer != 0                 &&
-           !IsDelimiter(*LineBuffer)        &&
-            strlen(Token) < MAX_TOKEN_LENGTH ) {
-        *TokenPtr++ = *LineBuffer++;
+    while( *LineBuffer != 0 && !IsDelimiter(*LineBuffer) ) {
+        if( TokenPtr < &Token[MAX_TOKEN_LENGTH] )
+            *TokenPtr++ = *LineBuffer;
+        LineBuffer++;
         }
+    *TokenPtr = 0;
 
     return(Token);
     }
+
+/////////////////////////////////////////////////////////////////////////////////
+//
+// ParseLongToken - Return the whole of the last token
+//
+// Inputs:      None.
+//
+// Outputs:     Ptr to last token, in the command buffer. It ends at the next
+//                delimiter (space or tab) or NUL.
+//
+char *ParseLongToken() {
+
+    return(TokenStart);
+    }
+
+/////////////////////////////////////////////////////////////////////////////////
+//
+// ParseRest - Return the rest of the line, and use it all up
+//
+// Inputs:      None.
+//
+// Outputs:     Ptr to rest of line after any delimiters, in the command buffer
+//
+char *ParseRest() {
+    char    *Rest;
+
+    while( *LineBuffer != 0 && IsDelimiter(*LineBuffer) )
+        LineBuffer++;
+
+    Rest        = LineBuffer;
+    LineBuffer += strlen(LineBuffer);
+
+    return(Rest);
+    }
@@ -61,6 +61,8 @@ void ParseInit(char *Buffer);
 //
 // ParseToken - Return next token in command buffer
 //
+// Tokens are cut short at 10 chars, which is plenty for commands and numbers.
+//
 // Inputs:      None.
 //
 // Outputs:     Ptr to next token in command buffer
@@ -68,4 +70,29 @@ void ParseInit(char *Buffer);
 //
 char *ParseToken(void);
 
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// ParseLongToken - Return the whole of the last token
+//
+// For tokens which may be long, such as packed hex data.
+//
+// Inputs:      None.
+//
+// Outputs:     Ptr to last token, in the command buffer. It ends at the next
+//                delimiter (space or tab) or NUL.
+//
+char *ParseLongToken(void);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// ParseRest - Return the rest of the line, and use it all up
+//
+// For free text, such as a list of commands.
+//
+// Inputs:      None.
+//
+// Outputs:     Ptr to rest of line after any delimiters, in the command buffer
+//
+char *ParseRest(void);
+
 #endif  // PARSE_H - Entire file 
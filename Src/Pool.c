@@ -0,0 +1,155 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2015 Peter Walsh, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      Pool.c
+//
+//  DESCRIPTION
+//
+//      Static block pool for job buffers
+//
+//      See Pool.h for a description of the interface.
+//
+//  VERSION:    2026.10.17
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include <stddef.h>
+
+#include "Pool.h"
+
+#if POOL_BLOCKS > 32
+#error "POOL_BLOCKS must be <= 32, one bit each in Used"
+#endif
+
+#define BLOCKS(_n_)     (((_n_)+POOL_BLOCK_SIZE-1)/POOL_BLOCK_SIZE)
+#define BIT(_b_)        (1UL << (_b_))
+
+static uint8_t    Pool[POOL_SIZE];
+static uint32_t   Used;                 // One bit per block, set if in use
+static POOL_STATS Stats;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// PoolAlloc - Borrow a buffer from the pool
+//
+// Inputs:      Least bytes which will do
+//              Most bytes wanted
+//              TRUE to take from the top of the pool (long lived buffers)
+//              Where to put the size given
+//
+// Outputs:     Ptr to buffer
+//              NULL if not enough contiguous space
+//
+uint8_t *PoolAlloc(uint8_t Min, uint8_t Max, bool FromTop, uint8_t *Size) {
+    uint8_t Want  = Max/POOL_BLOCK_SIZE;
+    uint8_t Start = 0;                  // Chosen run
+    uint8_t Len   = 0;
+    bool    Fits  = false;              // Chosen run holds Want blocks
+    uint8_t Run   = 0;                  // Free run being scanned
+    uint8_t Block;
+
+    //
+    // Runs are scanned bottom up. Of those big enough the first wins from the
+    //   bottom, and the last from the top. If none is, the largest wins.
+    //
+    for( Block = 0; Block <= POOL_BLOCKS; Block++ ) {
+        if( Block < POOL_BLOCKS && !(Used & BIT(Block)) ) {
+            Run++;
+            continue;
+            }
+
+        if( Run != 0 ) {
+            if( Run >= Want ? (!Fits || FromTop) :
+                              (!Fits && (Run > Len || (Run == Len && FromTop))) ) {
+                Start = Block - Run;
+                Len   = Run;
+                Fits  = Run >= Want;
+                }
+            }
+        Run = 0;
+        }
+
+    if( Len < BLOCKS(Min) || Len == 0 ) {
+        Stats.Fails++;
+        return(NULL);
+        }
+
+    if( Len > Want ) {
+        if( FromTop )
+            Start += Len - Want;
+        Len = Want;
+        }
+
+    for( Block = Start; Block < Start+Len; Block++ )
+        Used |= BIT(Block);
+
+    Stats.Allocs++;
+    Stats.InUse += Len;
+    if( Stats.InUse > Stats.Peak )
+        Stats.Peak = Stats.InUse;
+
+    *Size = Len*POOL_BLOCK_SIZE;
+    return(&Pool[Start*POOL_BLOCK_SIZE]);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// PoolFree - Return a buffer to the pool
+//
+// Inputs:      Buffer, as given by PoolAlloc()
+//              Size, as given by PoolAlloc()
+//
+// Outputs:     None.
+//
+void PoolFree(uint8_t *Buffer, uint8_t Size) {
+    uint8_t Block = (Buffer - Pool)/POOL_BLOCK_SIZE;
+    uint8_t Len   = Size/POOL_BLOCK_SIZE;
+
+    Stats.InUse -= Len;
+    while( Len-- )
+        Used &= ~BIT(Block++);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// PoolGetStats - Get allocation stats
+//
+// Inputs:      Where to put the stats
+//
+// Outputs:     None.
+//
+void PoolGetStats(POOL_STATS *Out) {
+
+    *Out = Stats;
+    }
@@ -0,0 +1,130 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2015 Peter Walsh, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      Pool.h
+//
+//  SYNOPSIS
+//
+//      Buffer = PoolAlloc(Min,Max,FromTop,&Size);  // Borrow Min to Max bytes
+//      PoolFree(Buffer,Size);                      // Give them back
+//
+//      PoolGetStats(&Stats);                       // Allocation stats
+//
+//  DESCRIPTION
+//
+//      Static block pool for job buffers
+//
+//      Data buffers are borrowed from one static pool of POOL_BLOCKS blocks, each
+//        POOL_BLOCK_SIZE bytes, instead of each job having its own buffer whether
+//        it's running or not. A buffer is a run of whole blocks, and a bitmap of
+//        blocks in use is the only bookkeeping, so there's no heap, no headers,
+//        and every call takes a bounded time.
+//
+//      Long lived buffers are taken from the top of the pool and short lived
+//        ones from the bottom. With the same sized buffers at the top, holes
+//        left there are refilled exactly, so the free space at the bottom stays
+//        in one piece.
+//
+//      Both sizes are set at compile time.
+//
+//  VERSION:    2026.10.17
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef POOL_H
+#define POOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// Pool size. At most 32 blocks, and a buffer can be at most 255 bytes.
+//
+#ifndef POOL_BLOCK_SIZE
+#define POOL_BLOCK_SIZE 16
+#endif
+
+#ifndef POOL_BLOCKS
+#define POOL_BLOCKS     18
+#endif
+
+#define POOL_SIZE       (POOL_BLOCKS*POOL_BLOCK_SIZE)
+
+typedef struct {
+    uint16_t    Allocs;                 // Buffers handed out
+    uint16_t    Fails;                  // Requests which couldn't be met
+    uint8_t     InUse;                  // Blocks in use now
+    uint8_t     Peak;                   // Most blocks ever in use
+    } POOL_STATS;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// PoolAlloc - Borrow a buffer from the pool
+//
+// The buffer is the first (or last) free run of blocks which holds Max bytes, or
+//   failing that the largest free run, if it holds at least Min.
+//
+// Inputs:      Least bytes which will do
+//              Most bytes wanted
+//              TRUE to take from the top of the pool (long lived buffers)
+//              Where to put the size given (whole blocks: Min rounded up, Max
+//                rounded down)
+//
+// Outputs:     Ptr to buffer
+//              NULL if not enough contiguous space
+//
+uint8_t *PoolAlloc(uint8_t Min, uint8_t Max, bool FromTop, uint8_t *Size);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// PoolFree - Return a buffer to the pool
+//
+// Inputs:      Buffer, as given by PoolAlloc()
+//              Size, as given by PoolAlloc()
+//
+// Outputs:     None.
+//
+void PoolFree(uint8_t *Buffer, uint8_t Size);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// PoolGetStats - Get allocation stats
+//
+// Inputs:      Where to put the stats
+//
+// Outputs:     None.
+//
+void PoolGetStats(POOL_STATS *Stats);
+
+#endif  // POOL_H - entire file
@@ -99,6 +99,24 @@
 #include "Serial.h"
 #include "UART.h"
 
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#define BULK_WRAP       (BULK_SIZE-1)   // Wraparound mask for bulk queue
+
+//
+// Bulk output is only moved to the UART when no more than this many chars of
+//   interactive output are waiting to go out. Keep this below the point where
+//   foreground tasks print, so that the foreground wins when both are ready.
+//
+#define BULK_LOW_WATER  8
+
+static struct {
+    char    Data[BULK_SIZE];
+    uint8_t In;                         // Queue input  pointer
+    uint8_t Out;                        // Queue output pointer
+    uint8_t Output;                     // Current output channel
+    } Bulk;
+
 //////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -108,7 +126,104 @@
 //
 // Outputs:     None.
 //
-void PrintChar(char Char) { PutUARTByteW(Char); }
+void PrintChar(char Char) {
+    uint8_t NewIn;
+
+    if( Bulk.Output == OUTPUT_TTY ) {
+        PutUARTByteW(Char);
+        return;
+        }
+
+    //
+    // Bulk output. Callers should have checked OutputRoom() first, but if not
+    //   we have to wait for the UART to drain.
+    //
+    NewIn = (Bulk.In+1) & BULK_WRAP;
+
+    while( NewIn == Bulk.Out ) {
+        if( !FlushBulk() )
+            WaitEvents(EV_UART_TX);
+        }
+
+    Bulk.Data[Bulk.In] = Char;
+    Bulk.In            = NewIn;
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// SetOutput - Select output channel for the Print functions
+//
+// Inputs:      OUTPUT_TTY or OUTPUT_BULK
+//
+// Outputs:     None.
+//
+void SetOutput(uint8_t Channel) { Bulk.Output = Channel; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// OutputRoom - Return free space on the current output channel
+//
+// Inputs:      None.
+//
+// Outputs:     Number of chars which can be printed without waiting
+//
+uint8_t OutputRoom(void) {
+
+    if( Bulk.Output == OUTPUT_TTY )
+        return(UARTRoom());
+
+    return( (Bulk.Out - Bulk.In - 1) & BULK_WRAP );
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// FlushBulk - Move one line of bulk output to the UART, if the UART is idle
+//
+// Only whole lines are moved, so interactive output can't land in the middle of
+//   a background line. A queue full of text with no EOL is moved as-is.
+//
+// Inputs:      None.
+//
+// Outputs:     TRUE  if anything was moved
+//              FALSE otherwise
+//
+bool FlushBulk(void) {
+    uint8_t Index;
+    uint8_t Length = 0;
+    uint8_t Room   = UARTRoom();
+
+    if( Bulk.In == Bulk.Out )
+        return(false);
+
+    if( Room < OFIFO_SIZE-1-BULK_LOW_WATER )
+        return(false);
+
+    for( Index = Bulk.Out; Index != Bulk.In; Index = (Index+1) & BULK_WRAP ) {
+        Length++;
+        if( Bulk.Data[Index] == '\n' )
+            break;
+        }
+
+    if( Index == Bulk.In &&                                     // No EOL yet
+        ((Bulk.In+1) & BULK_WRAP) != Bulk.Out )                 //   and not full
+        return(false);
+
+    if( Length > Room )
+        Length = Room;
+
+    while( Length-- ) {
+        PutUARTByte(Bulk.Data[Bulk.Out]);
+        Bulk.Out = (Bulk.Out+1) & BULK_WRAP;
+        }
+
+    return(true);
+    }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
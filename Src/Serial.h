@@ -31,6 +31,9 @@
 //
 //      PrintCRLF();                // => printf("/r/n");
 //
+//      SetOutput(OUTPUT_BULK);     // Send following output to the bulk queue
+//      FlushBulk();                // Move bulk output to the UART when it's idle
+//
 //      static const prog_char String1[] = "...";
 //
 //      PrintStringP(String1);      // => printf("%s",String);
@@ -99,6 +102,7 @@
 #define SERIAL_H
 
 #include <stdint.h>
+#include <stdbool.h>
 
 #include <avr/pgmspace.h>
 
@@ -195,4 +199,58 @@ void PrintChar(char Char);
 void PrintCRLF(void);
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// Output channels
+//
+// Interactive output goes straight to the UART. Background (bulk) output is held
+//   in a queue and only moved to the UART a whole line at a time, when the UART
+//   has (almost) nothing else to send. Interactive output therefore never waits
+//   behind more than one line of bulk data.
+//
+#define OUTPUT_TTY      0               // Interactive, straight to the UART
+#define OUTPUT_BULK     1               // Background, queued behind interactive
+
+#ifndef BULK_SIZE
+#define BULK_SIZE       (1 << 7)        // == 128 chars bulk queue
+#endif
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// SetOutput - Select output channel for the Print functions
+//
+// Inputs:      OUTPUT_TTY or OUTPUT_BULK
+//
+// Outputs:     None.
+//
+void SetOutput(uint8_t Channel);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// OutputRoom - Return free space on the current output channel
+//
+// Inputs:      None.
+//
+// Outputs:     Number of chars which can be printed without waiting
+//
+uint8_t OutputRoom(void);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// FlushBulk - Move one line of bulk output to the UART, if the UART is idle
+//
+// Inputs:      None.
+//
+// Outputs:     TRUE  if anything was moved
+//              FALSE otherwise
+//
+bool FlushBulk(void);
+
+
 #endif  // SERIAL_H - entire file
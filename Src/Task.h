@@ -0,0 +1,117 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2015 Peter Walsh, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      Task.h
+//
+//  SYNOPSIS
+//
+//      static uint8_t BlinkTask(void) {
+//          static TASK Task;                   // Resume point, must be static
+//
+//          TASK_BEGIN(Task);
+//          while(1) {
+//              TASK_WAIT(Task,!I2CBusy());     // Return to scheduler until true
+//              ...
+//              TASK_YIELD(Task);               // Let the other tasks run
+//              }
+//          TASK_END(Task);
+//          }
+//
+//  DESCRIPTION
+//
+//      Stackless cooperative tasks (protothreads), in the style of Duff's device.
+//
+//      A task is a function which is called over and over by the main loop. It
+//        picks up where it left off the last time, runs until it has to wait
+//        for something, then returns to the caller.
+//
+//      A task returns TASK_WAITING if it could not make any progress. When every
+//        task is waiting, the main loop sleeps until the next event (see Event.h).
+//
+//  NOTES
+//
+//      Local variables are NOT preserved across a wait or yield. Anything that
+//        must survive has to be static, or live in a structure owned by the task.
+//
+//      A task body cannot use its own switch() statement across a wait, and only
+//        one wait can appear on any source line.
+//
+//  VERSION:    2026.10.17
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef TASK_H
+#define TASK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef uint16_t TASK;                  // Resume point (source line), 0 == start
+
+typedef enum {
+    TASK_WAITING,                       // Blocked, made no progress
+    TASK_YIELDED,                       // Made progress, wants to run again
+    TASK_DONE,                          // Reached the end of the task
+    } TASK_STATE;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// TASK_INIT  - Restart the task from the beginning on the next call
+// TASK_BEGIN - Start of task body
+// TASK_END   - End of task body. Restarts the task and returns TASK_DONE.
+//
+#define TASK_INIT(_t_)          { (_t_) = 0; }
+
+#define TASK_BEGIN(_t_)         { bool _Ran_ = false; switch(_t_) { case 0: _Ran_ = true;
+
+#define TASK_END(_t_)           } (void) _Ran_; (_t_) = 0; return(TASK_DONE); }
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// TASK_WAIT  - Return to the scheduler until the condition is true
+// TASK_YIELD - Return to the scheduler once, to let the other tasks run
+// TASK_EXIT  - Abandon the task. Restarts the task and returns TASK_DONE.
+//
+// A task which made any progress during this call returns TASK_YIELDED instead of
+//   TASK_WAITING, since it may have changed something another task is waiting on.
+//
+#define TASK_WAIT(_t_,_c_)                                                              \
+    { (_t_) = __LINE__; case __LINE__:                                                  \
+      if( !(_c_) ) return(_Ran_ ? TASK_YIELDED : TASK_WAITING);                         \
+      _Ran_ = true;                                                                     \
+      }                                                                                 \
+
+#define TASK_YIELD(_t_)                                                                 \
+    { (_t_) = __LINE__; return(TASK_YIELDED); case __LINE__: _Ran_ = true; }            \
+
+#define TASK_EXIT(_t_)          { (_t_) = 0; return(TASK_DONE); }
+
+#endif  // TASK_H - entire file
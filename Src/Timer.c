@@ -0,0 +1,171 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2015 Peter Walsh, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      Timer.c
+//
+//  DESCRIPTION
+//
+//      A millisecond system tick. See Timer.h for details.
+//
+//  VERSION:    2026.10.17
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include <avr/interrupt.h>
+
+#include "PortMacros.h"
+#include "Event.h"
+#include "Timer.h"
+
+static uint32_t Ticks       NOINIT;     // Milliseconds since startup
+static uint16_t ResetCounts NOINIT;     // Timer counts from reset to TimerInit()
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// TimerStart - Start Timer1 free running, right after reset
+//
+// Runs from .init3, before .data and .bss are set up, so it can't use any
+//   variables. Naked, since the init sections fall through into each other.
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+static void TimerStart(void) __attribute__ ((naked, used, section (".init3")));
+
+static void TimerStart(void) {
+
+    TCCR1B = _PIN_MASK(CS11) | _PIN_MASK(CS10);             // Normal mode, F_CPU/64
+    }
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// TimerInit - Initialize the system tick
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void TimerInit(void) {
+
+    ResetCounts = TCNT1;                    // Counted since TimerStart()
+    Ticks       = 0;
+
+    _CLR_BIT(PRR,PRTIM1);                   // Power up Timer1
+
+    TCCR1A = 0;
+    TCCR1B = _PIN_MASK(WGM12);              // CTC mode, TOP == OCR1A
+    TCNT1  = 0;
+    OCR1A  = TIMER_COUNTS_MS-1;
+
+    _SET_BIT(TIMSK1,OCIE1A);                // Interrupt on compare match
+    _SET_MASK(TCCR1B,_PIN_MASK(CS11) | _PIN_MASK(CS10));    // Start, F_CPU/64
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// TimerMS - Return milliseconds since startup
+//
+// Inputs:      None.
+//
+// Outputs:     Milliseconds since startup
+//
+uint32_t TimerMS(void) {
+    uint32_t    Now;
+    uint8_t     SaveSREG = SREG;
+
+    cli();
+    Now = Ticks;
+    SREG = SaveSREG;
+
+    return(Now);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// TimerUS - Return microseconds since startup
+//
+// If the counter has just rolled over but the tick interrupt hasn't run yet, the
+//   millisecond count is one behind.
+//
+// Inputs:      None.
+//
+// Outputs:     Microseconds since startup
+//
+uint32_t TimerUS(void) {
+    uint32_t    Now;
+    uint16_t    Count;
+    uint8_t     SaveSREG = SREG;
+
+    cli();
+    Now   = Ticks;
+    Count = TCNT1;
+    if( _BIT_ON(TIFR1,OCF1A) && Count < TIMER_COUNTS_MS/2 )
+        Now++;
+    SREG = SaveSREG;
+
+    return(Now*1000 + Count*(1000/TIMER_COUNTS_MS));
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// TimerCycles - Return CPU cycles since reset
+//
+// Inputs:      None.
+//
+// Outputs:     Cycles since reset
+//
+uint32_t TimerCycles(void) {
+
+    return( (TimerUS() + ResetCounts*(1000/TIMER_COUNTS_MS)) * (F_CPU/1000000UL) );
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// TIMER1_COMPA_vect - Millisecond tick
+//
+// Inputs:      None. (ISR)
+//
+// Outputs:     None.
+//
+ISR(TIMER1_COMPA_vect) {
+
+    Ticks++;
+    PostEvent(EV_TICK);
+    }
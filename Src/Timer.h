@@ -0,0 +1,129 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2015 Peter Walsh, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      Timer.h
+//
+//  SYNOPSIS
+//
+//      TimerInit();                        // Called once at startup
+//
+//      uint32_t Now = TimerMS();           // Milliseconds since startup
+//
+//      uint32_t Boot = TimerCycles();      // CPU cycles since reset
+//
+//  DESCRIPTION
+//
+//      A millisecond system tick, using Timer1 in CTC mode.
+//
+//      Each tick posts EV_TICK, so tasks waiting for a time can sleep.
+//
+//      Timer1 is started from .init3, before the C runtime clears RAM, so the
+//        time taken by startup code before TimerInit() is counted as well.
+//
+//  VERSION:    2026.10.17
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <stdint.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// Timer1 runs at F_CPU/64 (== 4 us at 16 MHz), and rolls over every millisecond.
+//
+#define TIMER_PRESCALE      64
+#define TIMER_COUNTS_MS     (F_CPU/TIMER_PRESCALE/1000)
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// TimerInit - Initialize the system tick
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void TimerInit(void);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// TimerMS - Return milliseconds since startup
+//
+// Inputs:      None.
+//
+// Outputs:     Milliseconds since startup (wraps after ~49 days)
+//
+uint32_t TimerMS(void);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// TimerUS - Return microseconds since startup
+//
+// Resolution is one timer count (4 us). Safe to call from an ISR.
+//
+// Inputs:      None.
+//
+// Outputs:     Microseconds since startup (wraps after ~71 minutes)
+//
+uint32_t TimerUS(void);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// TimerCycles - Return CPU cycles since reset
+//
+// Resolution is one timer count (TIMER_PRESCALE cycles), and startup before
+//   TimerInit() must take less than one timer rollover (~260 ms).
+//
+// Inputs:      None.
+//
+// Outputs:     Cycles since reset (wraps after ~4 minutes)
+//
+uint32_t TimerCycles(void);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// TimerPast - Return TRUE if the specified time has been reached
+//
+// Inputs:      Time to check, in TimerMS() units
+//
+// Outputs:     TRUE  if time has been reached or passed
+//              FALSE otherwise
+//
+// Works correctly across a wrap of the millisecond count.
+//
+#define TimerPast(_t_)  ((int32_t) (TimerMS() - (_t_)) >= 0)
+
+#endif  // TIMER_H - entire file
@@ -0,0 +1,492 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2015 Peter Walsh, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      Trigger.c
+//
+//  DESCRIPTION
+//
+//      Pin triggered register reads
+//
+//      See Trigger.h for a description of the interface.
+//
+//  VERSION:    2026.10.17
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+#include <avr/interrupt.h>
+
+#include "PortMacros.h"
+#include "Timer.h"
+#include "Task.h"
+#include "Serial.h"
+#include "Job.h"
+#include "Trigger.h"
+#include "Log.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data declarations
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#define SAMPLE_WRAP     (SAMPLE_DEPTH-1)
+#define MAX_REFIRES     4               // Alert re-reads per SMBALERT# edge
+
+typedef struct {
+    TRIG_MODE           Mode;           // What to do on an edge
+    uint8_t             Bit;            // Pin in TRIG_PORT
+    uint8_t             SlaveAddr;      // Slave to read
+    uint8_t             Reg;            // Register to read
+    uint8_t             nBytes;         // # bytes to read
+    bool                Resolving;      // ARA done, reading the responder
+    uint8_t             Refires;        // Alert re-reads since the last edge
+    SAMPLE * volatile   Sample;         // Sample being filled, or NULL
+    uint16_t            Count;          // # times triggered
+    uint16_t            Lost;           // # edges dropped (busy or buffer full)
+    I2C_XFER            Xfer;           // Register read
+    } TRIGGER;
+
+static TRIGGER          Triggers[NUM_TRIGGERS];
+
+static SAMPLE           Samples[SAMPLE_DEPTH];
+static volatile uint8_t SampleIn;       // Next slot to reserve (ISR)
+static uint8_t          SampleOut;      // Oldest sample
+
+static const char ModeChars[] = "-RFBA";
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// TriggerInit - Initialize triggers (all off)
+//
+// Trigger pins are inputs with pullups, since SMBALERT# and most data-ready lines
+//   are open drain.
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void TriggerInit(void) {
+
+    memset(Triggers,0,sizeof(Triggers));
+
+    Triggers[0].Bit = TRIG0_BIT;
+    Triggers[1].Bit = TRIG1_BIT;
+    Triggers[2].Bit = TRIG2_BIT;
+
+    for( uint8_t i = 0; i < NUM_TRIGGERS; i++ ) {
+        _CLR_BIT(_DDR (TRIG_PORT),Triggers[i].Bit);
+        _SET_BIT(_PORT(TRIG_PORT),Triggers[i].Bit);
+        }
+
+    SampleIn  = 0;
+    SampleOut = 0;
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// SetTrigger - Configure a trigger
+//
+// A read already queued is cancelled; one on the bus finishes normally.
+//
+// Inputs:      Trigger # (0 .. NUM_TRIGGERS-1)
+//              Mode
+//              Slave to read (ignored for TRIG_ALERT)
+//              Register to read
+//              # bytes to read
+//
+// Outputs:     None.
+//
+void SetTrigger(uint8_t Trigger, TRIG_MODE Mode, uint8_t SlaveAddr, uint8_t Reg, uint8_t nBytes) {
+    TRIGGER *T = &Triggers[Trigger];
+    uint8_t  Sense;
+
+    //
+    // INTn sense bits: 01 => any change, 10 => falling, 11 => rising
+    //
+    if     ( Mode == TRIG_RISING ) Sense = 3;
+    else if( Mode == TRIG_BOTH   ) Sense = 1;
+    else                           Sense = 2;
+
+    cli();
+    if( Trigger == 0 ) {
+        _CLR_BIT(EIMSK,INT0);
+        EICRA = (EICRA & ~(_PIN_MASK(ISC01) | _PIN_MASK(ISC00))) | (Sense << ISC00);
+        }
+    else if( Trigger == 1 ) {
+        _CLR_BIT(EIMSK,INT1);
+        EICRA = (EICRA & ~(_PIN_MASK(ISC11) | _PIN_MASK(ISC10))) | (Sense << ISC10);
+        }
+    else _CLR_BIT(PCMSK2,PCINT20);
+
+    I2CCancel(&T->Xfer);
+
+    T->Mode      = Mode;
+    T->SlaveAddr = SlaveAddr;
+    T->Reg       = Reg;
+    T->nBytes    = nBytes;
+    T->Count     = 0;
+    T->Lost      = 0;
+
+    if( Mode != TRIG_OFF ) {
+        if( Trigger == 0 ) {
+            _SET_BIT(EIFR ,INTF0);          // Clear stale edge
+            _SET_BIT(EIMSK,INT0);
+            }
+        else if( Trigger == 1 ) {
+            _SET_BIT(EIFR ,INTF1);
+            _SET_BIT(EIMSK,INT1);
+            }
+        else {
+            _SET_BIT(PCIFR ,PCIF2);
+            _SET_BIT(PCMSK2,PCINT20);
+            _SET_BIT(PCICR ,PCIE2);
+            }
+        }
+    sei();
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// GetTrigger - Return a trigger's settings
+//
+// Inputs:      Trigger # (0 .. NUM_TRIGGERS-1)
+//              Where to put slave, register, and # bytes
+//
+// Outputs:     Mode of trigger
+//
+TRIG_MODE GetTrigger(uint8_t Trigger, uint8_t *SlaveAddr, uint8_t *Reg, uint8_t *nBytes) {
+    TRIGGER *T = &Triggers[Trigger];
+
+    *SlaveAddr = T->SlaveAddr;
+    *Reg       = T->Reg;
+    *nBytes    = T->nBytes;
+    return(T->Mode);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// Fire - Start a trigger's read
+//
+// Called from the pin interrupts (or with interrupts off). The pin change
+//   interrupt fires on both edges, so the edge is checked against the pin.
+//
+// Inputs:      Trigger #
+//              TRUE if called for a pin edge, FALSE for an alert re-read
+//
+// Outputs:     None.
+//
+static void Fire(uint8_t Trigger, bool Edge) {
+    TRIGGER *T    = &Triggers[Trigger];
+    bool     High = _BIT_ON(_PIN(TRIG_PORT),T->Bit);
+    SAMPLE  *Sample;
+    uint8_t  NewIn;
+
+    if( T->Mode == TRIG_OFF                  ||
+       (T->Mode == TRIG_RISING  && !High)    ||
+       (T->Mode == TRIG_FALLING &&  High)    ||
+       (T->Mode == TRIG_ALERT   &&  High)    )
+        return;
+
+    if( Edge )
+        T->Refires = 0;
+
+    NewIn = (SampleIn+1) & SAMPLE_WRAP;
+
+    if( T->Sample != NULL || T->Xfer.Status == I2C_WORKING || NewIn == SampleOut ) {
+        T->Lost++;
+        return;
+        }
+
+    Sample          = &Samples[SampleIn];
+    SampleIn        = NewIn;
+    Sample->Time    = TimerUS();
+    Sample->Channel = Trigger;
+    Sample->Status  = I2C_WORKING;
+
+    T->Xfer.Priority = I2C_PRI_HIGH;
+    T->Xfer.Flags    = 0;
+    T->Xfer.WrBytes  = 1;
+    T->Xfer.WrBuffer = &T->Reg;
+
+    if( T->Mode == TRIG_ALERT ) {
+        Sample->SlaveAddr = SMBUS_ARA;
+        Sample->nBytes    = 0;
+        T->Xfer.SlaveAddr = SMBUS_ARA;
+        T->Xfer.WrBytes   = 0;
+        T->Xfer.RdBytes   = 1;
+        T->Xfer.RdBuffer  = &Sample->SlaveAddr;
+        T->Resolving      = false;
+        }
+    else {
+        Sample->SlaveAddr = T->SlaveAddr;
+        Sample->nBytes    = T->nBytes;
+        T->Xfer.SlaveAddr = T->SlaveAddr;
+        T->Xfer.RdBytes   = T->nBytes;
+        T->Xfer.RdBuffer  = Sample->Data;
+        }
+
+    I2CSubmit(&T->Xfer);
+    T->Sample = Sample;
+    T->Count++;
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// INT0_vect   - Trigger 0
+// INT1_vect   - Trigger 1
+// PCINT2_vect - Trigger 2
+//
+// Inputs:      None. (ISR)
+//
+// Outputs:     None.
+//
+ISR(INT0_vect)   { Fire(0,true); }
+ISR(INT1_vect)   { Fire(1,true); }
+ISR(PCINT2_vect) { Fire(2,true); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// FinishRead - Deal with a finished trigger read
+//
+// An ARA read gives the address of the alerting device, whose registers are then
+//   read into the same sample. SMBALERT# is wired-OR, so if the line is still low
+//   another device is waiting its turn.
+//
+// A device which keeps the line low after answering (its alert condition wasn't
+//   cleared by the read) would otherwise be read forever, so the re-reads stop
+//   after MAX_REFIRES until the line goes high and falls again. Nothing is re-read
+//   unless every read succeeded: if nobody answered the ARA, or the responder
+//   didn't answer its register read, we wait for the next edge rather than hammer
+//   the bus.
+//
+// Inputs:      Trigger #
+//
+// Outputs:     None.
+//
+static void FinishRead(uint8_t Trigger) {
+    TRIGGER *T      = &Triggers[Trigger];
+    SAMPLE  *Sample = T->Sample;
+
+    if( T->Mode == TRIG_ALERT && !T->Resolving && T->Xfer.Status == I2C_COMPLETE ) {
+        Sample->SlaveAddr >>= 1;            // Responder puts its address in bits 7:1
+        T->Resolving = true;
+
+        if( T->nBytes ) {
+            Sample->nBytes    = T->nBytes;
+            T->Xfer.SlaveAddr = Sample->SlaveAddr;
+            T->Xfer.WrBytes   = 1;
+            T->Xfer.RdBytes   = T->nBytes;
+            T->Xfer.RdBuffer  = Sample->Data;
+            I2CSubmit(&T->Xfer);
+            return;
+            }
+        }
+
+    Sample->Status = T->Xfer.Status;
+    T->Sample      = NULL;
+
+    if( T->Mode == TRIG_ALERT                   &&
+        T->Xfer.Status == I2C_COMPLETE          &&
+        T->Refires < MAX_REFIRES                &&
+        _BIT_OFF(_PIN(TRIG_PORT),T->Bit)        ) {
+        T->Refires++;
+        cli();
+        Fire(Trigger,false);
+        sei();
+        }
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// GetSample - Take the oldest finished sample from the buffer
+//
+// Inputs:      Where to put sample
+//
+// Outputs:     TRUE  if a sample was returned
+//              FALSE if none ready
+//
+bool GetSample(SAMPLE *Sample) {
+
+    if( SampleOut == SampleIn || Samples[SampleOut].Status == I2C_WORKING )
+        return(false);
+
+    *Sample   = Samples[SampleOut];
+    SampleOut = (SampleOut+1) & SAMPLE_WRAP;
+    return(true);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// PutSample - Add a finished sample to the buffer
+//
+// The trigger interrupts also reserve slots, so interrupts are held off while
+//   the slot is taken.
+//
+// Inputs:      Sample to add (Status must not be I2C_WORKING)
+//
+// Outputs:     TRUE  if sample was added
+//              FALSE if buffer is full
+//
+bool PutSample(SAMPLE *Sample) {
+    uint8_t NewIn;
+
+    cli();
+    NewIn = (SampleIn+1) & SAMPLE_WRAP;
+    if( NewIn == SampleOut ) {
+        sei();
+        return(false);
+        }
+
+    Samples[SampleIn] = *Sample;
+    SampleIn = NewIn;
+    sei();
+    return(true);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// PrintSample - Print one sample: "T<n> <time>: <slave> <byte> <byte> ..."
+//
+// Inputs:      Sample to print
+//
+// Outputs:     None.
+//
+static void PrintSample(SAMPLE *Sample) {
+
+    PrintChar('T');
+    PrintD(Sample->Channel,0);
+    PrintChar(' ');
+    PrintH2(Sample->Time >> 16);
+    PrintH2(Sample->Time);
+    PrintString(": ");
+    PrintH(Sample->SlaveAddr);
+    PrintChar(' ');
+
+    if( Sample->Status != I2C_COMPLETE ) {
+        PrintStatus(Sample->Status);
+        return;
+        }
+
+    for( uint8_t i = 0; i < Sample->nBytes; i++ ) {
+        PrintH(Sample->Data[i]);
+        PrintChar(' ');
+        }
+    PrintCRLF();
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// TriggerTask - Finish trigger reads, print samples
+//
+// Inputs:      None.
+//
+// Outputs:     Task state
+//
+uint8_t TriggerTask(void) {
+    uint8_t Ran = TASK_WAITING;
+    SAMPLE  Sample;
+
+    for( uint8_t i = 0; i < NUM_TRIGGERS; i++ ) {
+        if( Triggers[i].Sample == NULL || Triggers[i].Xfer.Status == I2C_WORKING )
+            continue;
+        FinishRead(i);
+        Ran = TASK_YIELDED;
+        }
+
+    if( LogActive() )                   // Log takes the samples
+        return(Ran);
+
+    SetOutput(OUTPUT_BULK);
+    while( OutputRoom() >= MAX_LINE && GetSample(&Sample) ) {
+        PrintSample(&Sample);
+        Ran = TASK_YIELDED;
+        }
+    SetOutput(OUTPUT_TTY);
+
+    return(Ran);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// ListTriggers - Print trigger settings and counts ("T" command)
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void ListTriggers(void) {
+
+    PrintString("Trig Pin Mode Slave Reg nBytes Count Lost\r\n");
+
+    for( uint8_t i = 0; i < NUM_TRIGGERS; i++ ) {
+        TRIGGER *T = &Triggers[i];
+
+        PrintString("T");
+        PrintD(i,0);
+        PrintString("   PD");
+        PrintD(T->Bit,0);
+        PrintString("  ");
+        PrintChar(ModeChars[T->Mode]);
+        PrintString("    ");
+        PrintH(T->Mode == TRIG_ALERT ? SMBUS_ARA : T->SlaveAddr);
+        PrintString("    ");
+        PrintH(T->Reg);
+        PrintString("  ");
+        PrintH(T->nBytes);
+        PrintString("    ");
+        PrintD(T->Count,5);
+        PrintD(T->Lost,5);
+        PrintCRLF();
+        }
+    PrintCRLF();
+    }
@@ -0,0 +1,202 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2015 Peter Walsh, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      Trigger.h
+//
+//  SYNOPSIS
+//
+//      TriggerInit();                          // Called once at startup
+//
+//      SetTrigger(0,TRIG_FALLING,Slave,Reg,nBytes);// Read registers on INT0 edge
+//      SetTrigger(1,TRIG_ALERT,0,Reg,nBytes);  // SMBus alert on INT1
+//      SetTrigger(2,TRIG_OFF,0,0,0);           // Turn off pin change trigger
+//
+//      TriggerTask();                          // Finish reads, print samples
+//
+//      SAMPLE Sample;
+//      if( GetSample(&Sample) ) ...            // Oldest finished sample
+//      PutSample(&Sample);                     // Add a sample from elsewhere
+//
+//      Mode = GetTrigger(0,&Slave,&Reg,&nBytes);// Read back settings
+//
+//  DESCRIPTION
+//
+//      Pin triggered register reads
+//
+//      Each trigger pin has a preconfigured register read. On an edge the
+//        interrupt handler timestamps the event, reserves a slot in the sample
+//        buffer, and queues the read with the I2C driver on the spot; there's no
+//        bus traffic at all until a device asks for it.
+//
+//      In TRIG_ALERT mode the pin is an SMBus SMBALERT# line. The trigger reads
+//        the Alert Response Address, and then (if nBytes is set) the registers of
+//        whichever device answered. If the line is still low afterwards, another
+//        device is alerting and the process repeats, up to a few times per edge
+//        (a device which never releases the line can't tie up the bus).
+//
+//      Finished samples are printed on the bulk output channel (see Serial.h),
+//        except while the binary log (see Log.h) is running: then the log takes
+//        them with GetSample(), along with the samples which polling jobs add
+//        with PutSample().
+//
+//  VERSION:    2026.10.17
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef TRIGGER_H
+#define TRIGGER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "I2C.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// Trigger pins, all on PORTD
+//
+//  0 => INT0   (PD2)
+//  1 => INT1   (PD3)
+//  2 => PCINT20(PD4)
+//
+#define TRIG_PORT       D
+#define TRIG0_BIT       2
+#define TRIG1_BIT       3
+#define TRIG2_BIT       4
+
+#define NUM_TRIGGERS    3
+
+#define MAX_TRIGBYTES   8               // Max # bytes read per trigger
+#define SAMPLE_DEPTH    8               // Samples buffered (power of 2)
+
+#define SMBUS_ARA       0x0C            // SMBus Alert Response Address
+
+typedef enum {
+    TRIG_OFF,                           // Trigger disabled
+    TRIG_RISING,                        // Read on rising  edge
+    TRIG_FALLING,                       // Read on falling edge
+    TRIG_BOTH,                          // Read on either  edge
+    TRIG_ALERT,                         // SMBus alert (falling edge, ARA first)
+    } TRIG_MODE;
+
+typedef struct {
+    uint32_t    Time;                   // TimerUS() at the trigger edge
+    uint8_t     Channel;                // Trigger # which fired, or log channel
+    uint8_t     SlaveAddr;              // Device read (responder, for ARA)
+    I2C_STATUS  Status;                 // I2C_WORKING until the read is done
+    uint8_t     nBytes;                 // # bytes in Data
+    uint8_t     Data[MAX_TRIGBYTES];    // Register data
+    } SAMPLE;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// TriggerInit - Initialize triggers (all off)
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void TriggerInit(void);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// SetTrigger - Configure a trigger
+//
+// Inputs:      Trigger # (0 .. NUM_TRIGGERS-1)
+//              Mode
+//              Slave to read (ignored for TRIG_ALERT)
+//              Register to read
+//              # bytes to read (<= MAX_TRIGBYTES, may be 0 for TRIG_ALERT)
+//
+// Outputs:     None.
+//
+void SetTrigger(uint8_t Trigger, TRIG_MODE Mode, uint8_t SlaveAddr, uint8_t Reg, uint8_t nBytes);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// GetTrigger - Return a trigger's settings
+//
+// Inputs:      Trigger # (0 .. NUM_TRIGGERS-1)
+//              Where to put slave, register, and # bytes
+//
+// Outputs:     Mode of trigger
+//
+TRIG_MODE GetTrigger(uint8_t Trigger, uint8_t *SlaveAddr, uint8_t *Reg, uint8_t *nBytes);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// ListTriggers - Print trigger settings and counts ("T" command)
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void ListTriggers(void);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// GetSample - Take the oldest finished sample from the buffer
+//
+// Inputs:      Where to put sample
+//
+// Outputs:     TRUE  if a sample was returned
+//              FALSE if none ready
+//
+bool GetSample(SAMPLE *Sample);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// PutSample - Add a finished sample to the buffer
+//
+// Inputs:      Sample to add (Status must not be I2C_WORKING)
+//
+// Outputs:     TRUE  if sample was added
+//              FALSE if buffer is full
+//
+bool PutSample(SAMPLE *Sample);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// TriggerTask - Finish trigger reads, print samples
+//
+// Inputs:      None.
+//
+// Outputs:     Task state
+//
+uint8_t TriggerTask(void);
+
+#endif  // TRIGGER_H - entire file
@@ -13,12 +13,16 @@
 //
 //      char InChar = GetUARTByte();        // == 0 if no chars available
 //
+//      if( UARTReady() ) ...               // TRUE if input chars are waiting
+//
 //      bool Success = PutUARTByte('A');    // == FALSE if buffer was full
 //
 //      PutUARTByteW('A');                  // Block until complete
 //
 //      If( UARTBusy() ) ...                // TRUE if sending something
 //
+//      if( UARTRoom() >= 10 ) ...          // Free space in Tx FIFO
+//
 //  DESCRIPTION
 //
 //      A simple serial Rx/Tx driver module for interrupt driven communications
@@ -90,6 +94,7 @@ static struct {
     uint8_t Tx_FIFO_Out;                // FIFO output pointer
     uint8_t Rx_FIFO_In;                 // FIFO input  pointer
     uint8_t Rx_FIFO_Out;                // FIFO output pointer
+    bool    Rx_Overrun;                 // A char was dropped, FIFO full
     } UART NOINIT;
 
 
@@ -138,6 +143,35 @@ void UARTInit(void) {
     }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// UARTSetBaud - Change the baud rate
+//
+// Double speed mode halves the rounding error, so it's used unless the divisor
+//   won't fit in UBRR (12 bits).
+//
+// Inputs:      Baud rate
+//
+// Outputs:     None.
+//
+void UARTSetBaud(uint32_t Baud) {
+    uint32_t Div = (F_CPU + 4*Baud)/(8*Baud);
+
+    if( Div > 0x1000 ) {
+        Div = (F_CPU + 8*Baud)/(16*Baud);
+        _CLR_BIT(UCSR0A,U2X0);
+        }
+    else _SET_BIT(UCSR0A,U2X0);
+
+    if( Div > 0 )
+        Div--;
+
+    UBRR0H = Div >> 8;
+    UBRR0L = Div;
+    }
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -183,6 +217,9 @@ bool PutUARTByte(char OutChar) {
 // Get a char from the serial port. The interrupt handler already received the
 //   character for us, so this just pulls the char out of the receive FIFO.
 //
+// The ISR only ever writes Rx_FIFO_In and we only ever write Rx_FIFO_Out, and
+//   both are single bytes. No need to disable the Rx interrupt here.
+//
 // Inputs:      None
 //
 // Outputs:     ASCII char, if one was available
@@ -190,20 +227,52 @@ bool PutUARTByte(char OutChar) {
 //
 char GetUARTByte(void) {
     char    OutChar = 0;
+    uint8_t Out     = UART.Rx_FIFO_Out;
 
-    _CLR_BIT(UCSR0B,RXCIE0);                     // Disable UART interrupts
-
-    if( UART.Rx_FIFO_In != UART.Rx_FIFO_Out ) {
-        OutChar = UART.Rx_FIFO[UART.Rx_FIFO_Out];
-        UART.Rx_FIFO_Out = (UART.Rx_FIFO_Out+1) & IFIFO_WRAP;
+    if( UART.Rx_FIFO_In != Out ) {
+        OutChar = UART.Rx_FIFO[Out];
+        UART.Rx_FIFO_Out = (Out+1) & IFIFO_WRAP;
         }
 
-    _SET_BIT(UCSR0B,RXCIE0);                    // Enable UART interrupts
-
     return(OutChar);
     }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// UARTReady - Return TRUE if input chars are waiting
+//
+// Inputs:      None
+//
+// Outputs:     TRUE  if GetUARTByte() has a char to return
+//              FALSE if the Rx FIFO is empty
+//
+bool UARTReady(void) { return( UART.Rx_FIFO_In != UART.Rx_FIFO_Out ); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// UARTOverrun - Return TRUE if input was dropped since last time
+//
+// Inputs:      None
+//
+// Outputs:     TRUE  if a char was dropped because the Rx FIFO was full
+//              FALSE if not
+//
+bool UARTOverrun(void) {
+    bool Overrun;
+
+    _CLR_BIT(UCSR0B,RXCIE0);                    // Disable Rx interrupt
+    Overrun         = UART.Rx_Overrun;
+    UART.Rx_Overrun = false;
+    _SET_BIT(UCSR0B,RXCIE0);                    // Enable Rx interrupt
+
+    return(Overrun);
+    }
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -216,6 +285,17 @@ char GetUARTByte(void) {
 //
 bool UARTBusy(void) { return( UART.Tx_FIFO_In != UART.Tx_FIFO_Out ); }
 
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// UARTRoom - Return free space in the Tx FIFO
+//
+// Inputs:      None
+//
+// Outputs:     Number of chars which can be sent without waiting
+//
+uint8_t UARTRoom(void) { return( (UART.Tx_FIFO_Out - UART.Tx_FIFO_In - 1) & OFIFO_WRAP ); }
+
 //////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -244,8 +324,11 @@ ISR(USART_RX_vect) {
         }
 
     //
-    // No room - Drop the character
+    // No room - Drop the character, and say so
     //
+    else UART.Rx_Overrun = true;
+
+    PostEvent(EV_UART_RX);
     }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -268,6 +351,7 @@ ISR(USART_UDRE_vect) {
     if( UART.Tx_FIFO_In != UART.Tx_FIFO_Out ) {
         UDR0             = UART.Tx_FIFO[UART.Tx_FIFO_Out];
         UART.Tx_FIFO_Out = (UART.Tx_FIFO_Out+1) & OFIFO_WRAP;
+        PostEvent(EV_UART_TX);          // Room for another char
         }
 
     //
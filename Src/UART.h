@@ -10,15 +10,20 @@
 //  SYNOPSIS
 //
 //      UARTInit();                         // Called once at startup
+//      UARTSetBaud(115200);                // Not the compiled in BAUD
 //
 //      char InChar = GetUARTByte();        // == 0 if no chars available
 //
+//      if( UARTReady() ) ...               // TRUE if input chars are waiting
+//
 //      bool Success = PutUARTByte('A');    // == FALSE if buffer was full
 //
 //      PutUARTByteW('A');                  // Block until complete
 //
 //      If( UARTBusy() ) ...                // TRUE if sending something
 //
+//      if( UARTRoom() >= 10 ) ...          // Free space in Tx FIFO
+//
 //  DESCRIPTION
 //
 //      A simple serial Rx/Tx driver module for interrupt driven communications
@@ -72,9 +77,12 @@
 #ifndef UART_H
 #define UART_H
 
+#include <stdint.h>
 #include <stdbool.h>
 #include <avr/wdt.h>
 
+#include "Event.h"
+
 //////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -110,6 +118,20 @@
 //
 void UARTInit(void);
 
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// UARTSetBaud - Change the baud rate
+//
+// Call before anything is sent, or when the Tx FIFO is empty and the last char
+//   has gone.
+//
+// Inputs:      Baud rate
+//
+// Outputs:     None.
+//
+void UARTSetBaud(uint32_t Baud);
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -131,13 +153,14 @@ bool PutUARTByte(char OutChar);
 //
 // PutUARTByteW - Send one char out the serial port, wait for completion
 //
-// Like PutUARTByte, but will block [if no FIFO space] until complete.
+// Like PutUARTByte, but will block [if no FIFO space] until complete. The
+//   processor sleeps until the Tx interrupt makes room.
 //
 // Inputs:      Byte to send
 //
 // Outputs:     None.
 //
-#define PutUARTByteW(_OutChar_) { while(!PutUARTByte(_OutChar_)); }
+#define PutUARTByteW(_OutChar_) { while(!PutUARTByte(_OutChar_)) WaitEvents(EV_UART_TX); }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////
@@ -154,6 +177,33 @@ bool PutUARTByte(char OutChar);
 //
 char GetUARTByte(void);
 
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// UARTReady - Return TRUE if input chars are waiting
+//
+// Inputs:      None.
+//
+// Outputs:     TRUE  if GetUARTByte() has a char to return
+//              FALSE if the Rx FIFO is empty
+//
+bool UARTReady(void);
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// UARTOverrun - Return TRUE if input was dropped since last time
+//
+// The Rx FIFO is small, so input which isn't read for a few chars' time is lost.
+//   Code which can't afford to lose any (a streamed W line) checks this.
+//
+// Inputs:      None.
+//
+// Outputs:     TRUE  if a char was dropped because the Rx FIFO was full
+//              FALSE if not
+//
+bool UARTOverrun(void);
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -166,4 +216,18 @@ char GetUARTByte(void);
 //
 bool UARTBusy(void);
 
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// UARTRoom - Return free space in the Tx FIFO
+//
+// Tasks which must not block use this to check that a whole line of output will
+//   fit before printing it.
+//
+// Inputs:      None.
+//
+// Outputs:     Number of chars which can be sent without waiting
+//
+uint8_t UARTRoom(void);
+
 #endif // UART_H - entire file
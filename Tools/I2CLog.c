@@ -0,0 +1,281 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2015 Peter Walsh, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      I2CLog.c
+//
+//  SYNOPSIS
+//
+//      I2CLog [file]                           # Binary log => CSV on stdout
+//
+//      gcc -O2 -o I2CLog Tools/I2CLog.c        # Build (host, not AVR)
+//
+//  DESCRIPTION
+//
+//      Decode the binary sample log (see Src/Log.h) into CSV
+//
+//      Input is a raw capture of the serial port, from the file given or from
+//        stdin. Text before the log header (the LOG command echo, &c) is
+//        skipped, and several logs in one capture are decoded in turn.
+//
+//      Output has one line per record:
+//
+//          Time,Channel,Type,Slave,Status,Data...
+//
+//        Time is in us from the start of the log. Data is in decimal, one
+//        column per byte read. For alert channels Slave is the responder.
+//
+//  VERSION:    2026.10.17
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data declarations (must match Src/Log.h)
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#define LOG_VERSION     1
+
+#define MAX_CHANNELS    128
+#define MAX_VALUES      256
+
+#define LOG_ERROR       0x80
+#define LOG_END         0xFF
+
+typedef struct {
+    uint8_t     Type;                   // 'T', 'A', 'P', or 0 if not in header
+    uint8_t     SlaveAddr;
+    uint8_t     Reg;
+    uint8_t     nValues;
+    uint8_t     Prev[MAX_VALUES];       // Previous values
+    } CHANNEL;
+
+static CHANNEL  Channels[MAX_CHANNELS];
+static FILE    *In;
+
+static const char *StatusText[] = {
+    "I2C_COMPLETE",
+    "I2C_WORKING",
+    "I2C_NO_SLAVE_ACK",
+    "I2C_SLAVE_DATA_NACK",
+    "I2C_REP_START",
+    "I2C_MT_ARB_LOST",
+    "I2C_BUS_ERROR",
+    "I2C_CANCELLED",
+    "I2C_VERIFY_FAILED" };
+
+#define NUM_STATUS  (sizeof(StatusText)/sizeof(StatusText[0]))
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// GetByte - Return next byte of input, exit at end of file
+//
+// Inputs:      None.
+//
+// Outputs:     Next byte
+//
+static uint8_t GetByte(void) {
+    int Char = getc(In);
+
+    if( Char == EOF ) {
+        fprintf(stderr,"I2CLog: Unexpected end of file\n");
+        exit(1);
+        }
+
+    return(Char);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// GetVarint - Return next varint of input
+// GetZigZag - Return next zig-zag varint of input
+//
+// Inputs:      None.
+//
+// Outputs:     Value
+//
+static uint32_t GetVarint(void) {
+    uint32_t Value = 0;
+    uint8_t  Shift = 0;
+    uint8_t  Byte;
+
+    do {
+        Byte   = GetByte();
+        Value |= (uint32_t) (Byte & 0x7F) << Shift;
+        Shift += 7;
+        } while( (Byte & 0x80) && Shift < 35 );
+
+    return(Value);
+    }
+
+static int32_t GetZigZag(void) {
+    uint32_t Value = GetVarint();
+
+    return((int32_t) (Value >> 1) ^ -(int32_t) (Value & 1));
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// FindHeader - Skip input up to and including the next log magic
+//
+// Inputs:      None.
+//
+// Outputs:     TRUE  if header found
+//              FALSE if end of file
+//
+static bool FindHeader(void) {
+    static const char Magic[] = "I2CL";
+    uint8_t Matched = 0;
+    int     Char;
+
+    while( (Char = getc(In)) != EOF ) {
+        if     ( Char == Magic[Matched] ) Matched++;
+        else if( Char == Magic[0]       ) Matched = 1;
+        else                              Matched = 0;
+
+        if( Matched == sizeof(Magic)-1 )
+            return(true);
+        }
+
+    return(false);
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// DecodeLog - Decode one log, header to end marker
+//
+// Inputs:      None. (Input is just past the magic)
+//
+// Outputs:     None.
+//
+static void DecodeLog(void) {
+    uint8_t  Version   = GetByte();
+    uint8_t  nChannels = GetByte();
+    int64_t  Time      = 0;
+
+    if( Version != LOG_VERSION ) {
+        fprintf(stderr,"I2CLog: Unknown log version %d\n",Version);
+        exit(1);
+        }
+
+    memset(Channels,0,sizeof(Channels));
+
+    for( uint8_t i = 0; i < nChannels; i++ ) {
+        uint8_t ID = GetByte() & (MAX_CHANNELS-1);
+
+        Channels[ID].Type      = GetByte();
+        Channels[ID].SlaveAddr = GetByte();
+        Channels[ID].Reg       = GetByte();
+        Channels[ID].nValues   = GetByte();
+        }
+
+    while(1) {
+        uint8_t  ID = GetByte();
+        CHANNEL *C;
+        uint8_t  i;
+
+        if( ID == LOG_END )
+            return;
+
+        C     = &Channels[ID & ~LOG_ERROR];
+        Time += GetZigZag();
+
+        if( C->Type == 0 ) {
+            fprintf(stderr,"I2CLog: Record for unknown channel %d\n",ID & ~LOG_ERROR);
+            exit(1);
+            }
+
+        printf("%lld,%d,%c,",(long long) Time,ID & ~LOG_ERROR,C->Type);
+
+        if( ID & LOG_ERROR ) {
+            uint8_t Status = GetByte();
+
+            printf("0x%02X,%s\n",C->SlaveAddr,Status < NUM_STATUS ? StatusText[Status] : "?");
+            continue;
+            }
+
+        for( i = 0; i < C->nValues; i++ )
+            C->Prev[i] += GetZigZag();
+
+        i = 0;
+        if( C->Type == 'A' ) printf("0x%02X,OK",C->Prev[i++]);
+        else                 printf("0x%02X,OK",C->SlaveAddr);
+
+        for( ; i < C->nValues; i++ )
+            printf(",%d",C->Prev[i]);
+        printf("\n");
+        }
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// I2CLog - Decode the binary sample log into CSV
+//
+// Inputs:      Capture file (stdin if none)
+//
+// Outputs:     0 if OK, 1 on error
+//
+int main(int argc, char *argv[]) {
+
+    In = stdin;
+
+    if( argc > 2 ) {
+        fprintf(stderr,"Usage: I2CLog [file]\n");
+        return(1);
+        }
+
+    if( argc == 2 && (In = fopen(argv[1],"rb")) == NULL ) {
+        perror(argv[1]);
+        return(1);
+        }
+
+    printf("Time,Channel,Type,Slave,Status,Data\n");
+
+    while( FindHeader() )
+        DecodeLog();
+
+    return(0);
+    }